@@ -0,0 +1,374 @@
+// CRM Benchmark Suite
+// Generates a synthetic CRM population and measures per-operation latency.
+//
+// Build: cmake --build build --target crm_bench
+// Run:   ./build/crm_bench --customers 100000 --reps 50 --interactions 1000000
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "crm/crm.h"
+#include "crm/interaction_index.h"
+#include "crm/logger.h"
+#include "crm/metrics.h"
+#include "crm/text_codec.h"
+
+// Latency samples for one operation
+class LatencyRecorder {
+private:
+    std::string name;
+    std::vector<uint64_t> samples;  // nanoseconds
+    double totalSeconds = 0;
+
+public:
+    explicit LatencyRecorder(const std::string& name) : name(name) {}
+    
+    // Time a single call of op
+    template <typename Op>
+    void measure(Op&& op) {
+        auto start = std::chrono::steady_clock::now();
+        op();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        totalSeconds += std::chrono::duration<double>(elapsed).count();
+    }
+    
+    void print() {
+        if (samples.empty())
+            return;
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [this](double p) {
+            return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+        };
+        std::printf("%-24s %10zu %10.0f %9lu %9lu %9lu %11lu %12.0f\n", name.c_str(), samples.size(),
+                    totalSeconds * 1e9 / samples.size(), percentile(0.50), percentile(0.90),
+                    percentile(0.99), samples.back(), samples.size() / totalSeconds);
+    }
+};
+
+// Benchmark configuration, set from the command line
+struct BenchConfig {
+    size_t customers = 100000;
+    size_t reps = 50;
+    size_t interactions = 500000;
+    size_t lookups = 100000;
+    size_t displays = 10000;
+    size_t reports = 20;
+    size_t indexDocs = 1000000;  // documents for the standalone search index run
+    int regularShare = 70, vipShare = 20, corporateShare = 10;
+    int callShare = 50, emailShare = 30, meetingShare = 20;
+    unsigned seed = 42;
+    std::string metricsFormat;  // "text" or "json" to dump the CRM metrics
+};
+
+static bool parseShares(const char* text, int& a, int& b, int& c) {
+    return std::sscanf(text, "%d:%d:%d", &a, &b, &c) == 3 && a >= 0 && b >= 0 && c >= 0 && a + b + c > 0;
+}
+
+static void printUsage() {
+    std::printf("Usage: crm_bench [options]\n"
+                "  --customers N        customers to create (default 100000)\n"
+                "  --reps N             sales reps (default 50)\n"
+                "  --interactions N     interactions to record (default 500000)\n"
+                "  --lookups N          customer lookups and searches (default 100000)\n"
+                "  --displays N         interaction displays (default 10000)\n"
+                "  --reports N          report runs (default 20)\n"
+                "  --index-docs N       documents in the standalone search index run, 0 to skip\n"
+                "                       (default 1000000)\n"
+                "  --mix R:V:C          regular:vip:corporate mix (default 70:20:10)\n"
+                "  --types C:E:M        call:email:meeting mix (default 50:30:20)\n"
+                "  --seed N             random seed (default 42)\n"
+                "  --metrics FORMAT     print the CRM latency metrics as text or json\n");
+}
+
+static bool parseArgs(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) {
+            printUsage();
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--customers") config.customers = std::strtoul(value, nullptr, 10);
+        else if (arg == "--reps") config.reps = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        else if (arg == "--interactions") config.interactions = std::strtoul(value, nullptr, 10);
+        else if (arg == "--lookups") config.lookups = std::strtoul(value, nullptr, 10);
+        else if (arg == "--displays") config.displays = std::strtoul(value, nullptr, 10);
+        else if (arg == "--reports") config.reports = std::strtoul(value, nullptr, 10);
+        else if (arg == "--index-docs") config.indexDocs = std::strtoul(value, nullptr, 10);
+        else if (arg == "--seed") config.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        else if (arg == "--metrics" && (std::string(value) == "text" || std::string(value) == "json"))
+            config.metricsFormat = value;
+        else if (arg == "--mix" && parseShares(value, config.regularShare, config.vipShare, config.corporateShare)) {}
+        else if (arg == "--types" && parseShares(value, config.callShare, config.emailShare, config.meetingShare)) {}
+        else {
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Generates realistic-looking names and interaction text
+class WorkloadGenerator {
+private:
+    std::mt19937 rng;
+    
+    const std::vector<std::string> firstNames = {"John", "Jane", "Bob", "Alice", "Maria", "Wei",
+        "Priya", "Carlos", "Fatima", "Olga", "Kenji", "Amara", "Liam", "Noah", "Emma", "Sofia"};
+    const std::vector<std::string> lastNames = {"Smith", "Johnson", "Garcia", "Chen", "Patel",
+        "Kim", "Nguyen", "Mueller", "Rossi", "Silva", "Khan", "Brown", "Lopez", "Tanaka"};
+    const std::vector<std::string> segments = {"Small Business", "Retail", "Education", "Healthcare",
+        "Startup", "Nonprofit", "Government", "Hospitality"};
+    const std::vector<std::string> locations = {"Headquarters", "Client's Office", "Video Call",
+        "Regional Office", "Conference Center", "Cafe"};
+    const std::vector<std::string> subjects = {"Follow-up", "Renewal Reminder", "VIP Exclusive Offer",
+        "Invoice", "Product Update", "Support Ticket", "Meeting Notes"};
+    const std::vector<std::string> words = {"discussed", "renewal", "pricing", "contract", "support",
+        "installation", "upgrade", "features", "invoice", "payment", "training", "onboarding",
+        "feedback", "requirements", "schedule", "follow-up", "next", "week", "quarter", "team",
+        "product", "demo", "discount", "integration", "issue", "resolved", "escalated", "budget"};
+
+public:
+    explicit WorkloadGenerator(unsigned seed) : rng(seed) {}
+    
+    size_t uniform(size_t n) { return std::uniform_int_distribution<size_t>(0, n - 1)(rng); }
+    
+    // Index 0, 1 or 2 drawn according to the shares
+    int pick(int a, int b, int c) {
+        int roll = static_cast<int>(uniform(static_cast<size_t>(a + b + c)));
+        return roll < a ? 0 : roll < a + b ? 1 : 2;
+    }
+    
+    const std::string& from(const std::vector<std::string>& values) { return values[uniform(values.size())]; }
+    
+    std::string name() { return from(firstNames) + " " + from(lastNames); }
+    std::string email(size_t n) { return "customer" + std::to_string(n) + "@example.com"; }
+    std::string phone() { return "555-" + std::to_string(1000 + uniform(9000)); }
+    std::string segment() { return from(segments); }
+    std::string location() { return from(locations); }
+    std::string subject() { return from(subjects); }
+    int duration() { return 5 + static_cast<int>(uniform(115)); }
+    
+    std::string content() {
+        std::string text = from(words);
+        size_t count = 4 + uniform(20);
+        for (size_t i = 0; i < count; ++i)
+            text += " " + from(words);
+        return text;
+    }
+};
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config))
+        return 1;
+    
+    // Keep side-effect output out of the measurements
+    Logger::instance().setLevel(LogLevel::Off);
+    std::ostringstream discard;
+    std::streambuf* consoleBuffer = std::cout.rdbuf();
+    auto silence = [&discard]() { std::cout.rdbuf(discard.rdbuf()); };
+    auto restore = [&discard, consoleBuffer]() {
+        std::cout.rdbuf(consoleBuffer);
+        discard.str("");
+    };
+    
+    std::printf("customers=%zu reps=%zu interactions=%zu mix=%d:%d:%d types=%d:%d:%d seed=%u\n\n",
+                config.customers, config.reps, config.interactions, config.regularShare, config.vipShare,
+                config.corporateShare, config.callShare, config.emailShare, config.meetingShare, config.seed);
+    std::printf("%-24s %10s %10s %9s %9s %9s %11s %12s\n", "operation", "count", "mean ns",
+                "p50 ns", "p90 ns", "p99 ns", "max ns", "ops/sec");
+    
+    // Cost of the per-operation instrumentation itself
+    const size_t timerRuns = 1000000;
+    Metrics& metrics = Metrics::instance();
+    auto timerStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < timerRuns; ++i)
+        OperationTimer timer(Operation::GetCustomer);
+    double enabledNanos = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - timerStart).count() / timerRuns;
+    metrics.setEnabled(false);
+    timerStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < timerRuns; ++i)
+        OperationTimer timer(Operation::GetCustomer);
+    double disabledNanos = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - timerStart).count() / timerRuns;
+    metrics.setEnabled(true);
+    metrics.reset();
+    
+    WorkloadGenerator gen(config.seed);
+    CRM crm;
+    std::vector<int> customerIds;
+    std::vector<int> repIds;
+    
+    LatencyRecorder createRep("createSalesRep");
+    for (size_t i = 0; i < config.reps; ++i) {
+        std::string name = gen.name();
+        createRep.measure([&] { repIds.push_back(crm.createSalesRepresentative(name)->getId()); });
+    }
+    
+    LatencyRecorder create("createCustomer");
+    for (size_t i = 0; i < config.customers; ++i) {
+        std::string name = gen.name(), email = gen.email(i), phone = gen.phone();
+        int kind = gen.pick(config.regularShare, config.vipShare, config.corporateShare);
+        std::string extra = kind == 2 ? "Company " + std::to_string(i) : kind == 1 ? gen.name() : gen.segment();
+        int employees = 10 + static_cast<int>(gen.uniform(5000));
+        double contract = 1000.0 * (1 + gen.uniform(100));
+        create.measure([&] {
+            const Customer* customer;
+            if (kind == 0)
+                customer = crm.createRegularCustomer(name, email, phone, extra);
+            else if (kind == 1)
+                customer = crm.createVIPCustomer(name, email, phone, extra);
+            else
+                customer = crm.createCorporateCustomer(name, email, phone, extra, employees, contract);
+            customerIds.push_back(customer->getId());
+        });
+    }
+    
+    LatencyRecorder assign("assignCustomerToRep");
+    silence();
+    for (int customerId : customerIds) {
+        int repId = repIds[gen.uniform(repIds.size())];
+        assign.measure([&] { crm.assignCustomerToRep(customerId, repId); });
+    }
+    restore();
+    
+    LatencyRecorder autoAssign("autoAssignCustomer");
+    silence();
+    for (size_t i = 0; i < std::min<size_t>(config.customers, 10000); ++i) {
+        int customerId = customerIds[gen.uniform(customerIds.size())];
+        autoAssign.measure([&] { crm.autoAssignCustomer(customerId); });
+    }
+    restore();
+    
+    LatencyRecorder recordCall("recordCall");
+    LatencyRecorder recordEmail("recordEmail");
+    LatencyRecorder recordMeeting("recordMeeting");
+    for (size_t i = 0; i < config.interactions && !customerIds.empty(); ++i) {
+        const Customer* customer = crm.getCustomer(customerIds[gen.uniform(customerIds.size())]);
+        SalesRepresentative* rep = crm.getSalesRepresentative(customer->getRepId());
+        int customerId = customer->getId();
+        std::string content = gen.content();
+        switch (gen.pick(config.callShare, config.emailShare, config.meetingShare)) {
+            case 0: {
+                int duration = gen.duration();
+                recordCall.measure([&] { rep->recordCall(customerId, content, duration); });
+                break;
+            }
+            case 1: {
+                std::string subject = gen.subject();
+                recordEmail.measure([&] { rep->recordEmail(customerId, content, subject); });
+                break;
+            }
+            default: {
+                std::string location = gen.location();
+                int duration = gen.duration();
+                recordMeeting.measure([&] { rep->recordMeeting(customerId, content, location, duration); });
+                break;
+            }
+        }
+    }
+    
+    LatencyRecorder lookup("getCustomer");
+    LatencyRecorder search("searchInteractions");
+    const std::vector<std::string> queries = {"renewal", "contract pricing", "\"next week\"",
+                                              "upgrade OR discount", "escalated issue"};
+    size_t sink = 0;
+    for (size_t i = 0; i < config.lookups && !customerIds.empty(); ++i) {
+        int customerId = customerIds[gen.uniform(customerIds.size())];
+        lookup.measure([&] { sink += crm.getCustomer(customerId) != nullptr; });
+    }
+    for (size_t i = 0; i < std::min<size_t>(config.lookups, 200); ++i) {
+        const std::string& query = queries[i % queries.size()];
+        search.measure([&] { sink += crm.searchInteractions(query).size(); });
+    }
+    
+    LatencyRecorder display("viewCustomerInteractions");
+    silence();
+    for (size_t i = 0; i < config.displays && !customerIds.empty(); ++i) {
+        const Customer* customer = crm.getCustomer(customerIds[gen.uniform(customerIds.size())]);
+        SalesRepresentative* rep = crm.getSalesRepresentative(customer->getRepId());
+        int customerId = customer->getId();
+        display.measure([&] { rep->viewCustomerInteractions(customerId); });
+    }
+    restore();
+    
+    LatencyRecorder systemReport("generateSystemReport");
+    LatencyRecorder repReport("repInteractionReport");
+    LatencyRecorder topK("top100Customers");
+    LatencyRecorder revenue("generateRevenueReport");
+    silence();
+    for (size_t i = 0; i < config.reports; ++i) {
+        systemReport.measure([&] { crm.generateSystemReport(); });
+        SalesRepresentative* rep = crm.getSalesRepresentative(repIds[gen.uniform(repIds.size())]);
+        repReport.measure([&] { rep->generateInteractionTimeReport(); });
+        topK.measure([&] { sink += crm.getTopCustomersByInteractionTime(100).size(); });
+        revenue.measure([&] { crm.generateRevenueReport(); });
+    }
+    restore();
+    
+    LatencyRecorder compress("TextCodec::compress");
+    LatencyRecorder decompress("TextCodec::decompress");
+    size_t rawBytes = 0, packedBytes = 0;
+    std::string decoded;
+    for (size_t i = 0; i < std::min<size_t>(config.interactions, 100000); ++i) {
+        std::string text = gen.content();
+        std::string packed;
+        compress.measure([&] { packed = TextCodec::compress(text); });
+        decompress.measure([&] { TextCodec::decompress(packed, decoded); });
+        rawBytes += text.size();
+        packedBytes += packed.size();
+    }
+    
+    // Search latency at scale, on an index built directly from generated text. Every
+    // document also carries a case number shared by about 100 documents, so queries
+    // can pair a rare term with common ones.
+    LatencyRecorder rareAndCommon("index: rare AND common");
+    LatencyRecorder phraseAndRare("index: phrase AND rare");
+    LatencyRecorder commonAndCommon("index: common AND common");
+    size_t indexBytes = 0;
+    if (config.indexDocs > 0) {
+        InteractionIndex index;
+        size_t cases = std::max<size_t>(1, config.indexDocs / 100);
+        for (size_t doc = 0; doc < config.indexDocs; ++doc)
+            index.addInteraction(static_cast<int>(doc), 0, gen.content() + " case" + std::to_string(gen.uniform(cases)));
+        indexBytes = index.getMemoryUsage();
+        for (size_t i = 0; i < 200; ++i) {
+            std::string caseTerm = "case" + std::to_string(gen.uniform(cases));
+            rareAndCommon.measure([&] { sink += index.search("renewal pricing " + caseTerm).size(); });
+            phraseAndRare.measure([&] { sink += index.search("\"next week\" " + caseTerm).size(); });
+        }
+        for (size_t i = 0; i < 5; ++i)
+            commonAndCommon.measure([&] { sink += index.search("renewal pricing").size(); });
+    }
+    
+    for (LatencyRecorder* recorder : {&createRep, &create, &assign, &autoAssign, &recordCall, &recordEmail,
+                                      &recordMeeting, &lookup, &search, &display, &systemReport, &repReport,
+                                      &topK, &revenue, &compress, &decompress, &rareAndCommon, &phraseAndRare,
+                                      &commonAndCommon})
+        recorder->print();
+    
+    if (config.indexDocs > 0)
+        std::printf("\nsearch index: %zu documents, %.1f MB\n", config.indexDocs, indexBytes / 1e6);
+    if (packedBytes > 0)
+        std::printf("\ncontent compression: %zu -> %zu bytes (ratio %.2f)\n", rawBytes, packedBytes,
+                    static_cast<double>(rawBytes) / packedBytes);
+    std::printf("metrics overhead: %.1f ns per operation (%.1f ns with metrics disabled)\n",
+                enabledNanos, disabledNanos);
+    if (config.metricsFormat == "text")
+        std::printf("\n%s", metrics.toText().c_str());
+    else if (config.metricsFormat == "json")
+        std::printf("\n%s\n", metrics.toJson().c_str());
+    std::printf("checksum: %zu\n", sink);
+    return 0;
+}
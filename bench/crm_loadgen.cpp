@@ -0,0 +1,468 @@
+// CRM Load Generator
+// Drives a running crm_server over many pipelined connections and reports
+// throughput and request latency.
+//
+// Build: cmake --build build --target crm_loadgen
+// Run:   ./build/crm_server & ./build/crm_loadgen --connections 1000 --depth 8 --requests 1000000
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "crm/crm_client.h"
+#include "crm/crm_server.h"
+#include "crm/metrics.h"
+#include "crm/service_protocol.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Load generator configuration, set from the command line
+struct LoadConfig {
+    std::string host = "127.0.0.1";
+    uint16_t port = 7070;
+    size_t connections = 100;
+    size_t threads = 1;
+    size_t depth = 1;
+    size_t batch = 1;    // operations per frame; above 1 every frame is a Batch request
+    size_t requests = 200000;
+    size_t customers = 10000;
+    size_t reps = 20;
+    int readShare = 50;  // percent of requests that are lookups; the rest record interactions
+    unsigned seed = 42;
+};
+
+static void printUsage() {
+    std::printf("Usage: crm_loadgen [options]\n"
+                "  --host ADDRESS       server address (default 127.0.0.1)\n"
+                "  --port PORT          server port (default 7070)\n"
+                "  --connections N      concurrent connections (default 100)\n"
+                "  --threads N          client threads sharing the connections (default 1)\n"
+                "  --depth N            frames in flight per connection (default 1)\n"
+                "  --batch N            operations per frame (default 1, no batching)\n"
+                "  --requests N         total operations to send (default 200000)\n"
+                "  --customers N        customers to create before the run (default 10000)\n"
+                "  --reps N             sales reps to create before the run (default 20)\n"
+                "  --reads PERCENT      share of lookups vs. recorded interactions (default 50)\n"
+                "  --seed N             random seed (default 42)\n");
+}
+
+static bool parseArgs(int argc, char** argv, LoadConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc) {
+            printUsage();
+            return false;
+        }
+        const char* value = argv[++i];
+        unsigned long number = std::strtoul(value, nullptr, 10);
+        if (arg == "--host") config.host = value;
+        else if (arg == "--port" && number <= 65535) config.port = static_cast<uint16_t>(number);
+        else if (arg == "--connections") config.connections = std::max<size_t>(1, number);
+        else if (arg == "--threads") config.threads = std::max<size_t>(1, number);
+        else if (arg == "--depth") config.depth = std::max<size_t>(1, number);
+        else if (arg == "--batch") config.batch = std::max<size_t>(1, number);
+        else if (arg == "--requests") config.requests = number;
+        else if (arg == "--customers") config.customers = std::max<size_t>(1, number);
+        else if (arg == "--reps") config.reps = std::max<size_t>(1, number);
+        else if (arg == "--reads" && number <= 100) config.readShare = static_cast<int>(number);
+        else if (arg == "--seed") config.seed = static_cast<unsigned>(number);
+        else {
+            printUsage();
+            return false;
+        }
+    }
+    config.threads = std::min(config.threads, config.connections);
+    return true;
+}
+
+// The population created before the run: customer ids and the rep each is assigned to
+struct Population {
+    std::vector<uint32_t> customerIds;
+    std::vector<uint32_t> repOf;
+};
+
+// Send a batch of requests over one connection and collect the responses in order
+static bool callAll(CrmClient& client, const std::vector<ServiceRequest>& requests,
+                    std::vector<ServiceResponse>& responses) {
+    responses.resize(requests.size());
+    for (const auto& request : requests)
+        client.send(request);
+    for (auto& response : responses) {
+        if (!client.receive(response) || response.status != ServiceStatus::Ok)
+            return false;
+    }
+    return true;
+}
+
+static bool populate(const LoadConfig& config, Population& population) {
+    CrmClient client;
+    if (!client.connect(config.host, config.port)) {
+        std::fprintf(stderr, "Could not connect to %s:%u\n", config.host.c_str(), config.port);
+        return false;
+    }
+    
+    std::vector<ServiceRequest> requests;
+    std::vector<ServiceResponse> responses;
+    std::vector<uint32_t> repIds;
+    for (size_t i = 0; i < config.reps; ++i) {
+        ServiceRequest request;
+        request.op = ServiceOp::CreateRep;
+        request.name = "Load Rep " + std::to_string(i);
+        requests.push_back(request);
+    }
+    if (!callAll(client, requests, responses))
+        return false;
+    for (const auto& response : responses)
+        repIds.push_back(response.value);
+    
+    // Create and assign customers in pipelined chunks
+    const size_t chunk = 1000;
+    for (size_t start = 0; start < config.customers; start += chunk) {
+        size_t end = std::min(config.customers, start + chunk);
+        requests.clear();
+        for (size_t i = start; i < end; ++i) {
+            ServiceRequest request;
+            request.op = ServiceOp::CreateCustomer;
+            request.kind = static_cast<CustomerKind>(i % 3);
+            request.name = "Load Customer " + std::to_string(i);
+            request.email = "customer" + std::to_string(i) + "@example.com";
+            request.phone = "555-" + std::to_string(1000000 + i);
+            request.group = request.kind == CustomerKind::Corporate ? "Company " + std::to_string(i % 97) : "Group";
+            request.employees = 100;
+            request.annualContract = 10000;
+            requests.push_back(request);
+        }
+        if (!callAll(client, requests, responses))
+            return false;
+        
+        requests.clear();
+        for (size_t i = start; i < end; ++i) {
+            ServiceRequest request;
+            request.op = ServiceOp::Assign;
+            request.customerId = responses[i - start].value;
+            request.repId = repIds[i % repIds.size()];
+            population.customerIds.push_back(request.customerId);
+            population.repOf.push_back(request.repId);
+            requests.push_back(request);
+        }
+        if (!callAll(client, requests, responses))
+            return false;
+    }
+    return true;
+}
+
+// One client connection keeping up to `depth` requests in flight
+struct LoadConnection {
+    int fd = -1;
+    size_t remaining = 0;       // operations still to send
+    std::string output;
+    size_t outputOffset = 0;
+    std::string input;
+    std::deque<Clock::time_point> inflight;  // frame send times, answered in order
+    bool writing = false;
+};
+
+// Shared results of all load threads
+struct LoadResults {
+    LatencyHistogram latency;  // per frame, nanoseconds
+    std::atomic<uint64_t> operations{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<bool> failed{false};
+};
+
+// Open a blocking connection, then switch it to non-blocking for the event loop
+static int openConnection(const LoadConfig& config) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(config.port);
+    if (::inet_pton(AF_INET, config.host.c_str(), &address.sin_addr) != 1)
+        return -1;
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    int noDelay = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+// Drives a share of the connections from one thread with its own epoll loop
+class LoadThread {
+private:
+    const LoadConfig& config;
+    const Population& population;
+    LoadResults& results;
+    std::mt19937 rng;
+    std::vector<LoadConnection> connections;
+    int epollFd = -1;
+    ServiceRequest request;
+    ServiceResponse response;
+    
+    // Fill in a random lookup or record request
+    void makeRequest(ServiceRequest& item);
+    
+    // Queue frames until the connection has `depth` in flight or no operations are left
+    void fillRequests(LoadConnection& connection);
+    
+    // Send queued output; false if the connection failed
+    bool flush(LoadConnection& connection);
+    
+    // Read and account for every response available; false if the connection failed
+    bool readResponses(LoadConnection& connection);
+    
+    void setWriting(LoadConnection& connection, bool writing);
+
+public:
+    LoadThread(const LoadConfig& config, const Population& population, LoadResults& results, unsigned seed)
+        : config(config), population(population), results(results), rng(seed) {}
+    
+    ~LoadThread() {
+        for (auto& connection : connections)
+            ::close(connection.fd);
+        if (epollFd >= 0)
+            ::close(epollFd);
+    }
+    
+    // Open `count` connections sharing `requests` requests between them
+    bool connect(size_t count, size_t requests);
+    
+    void run();
+};
+
+bool LoadThread::connect(size_t count, size_t requests) {
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0)
+        return false;
+    connections.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        LoadConnection& connection = connections[i];
+        connection.fd = openConnection(config);
+        if (connection.fd < 0)
+            return false;
+        connection.remaining = requests / count + (i < requests % count ? 1 : 0);
+        
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = i;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, connection.fd, &event);
+    }
+    return true;
+}
+
+void LoadThread::makeRequest(ServiceRequest& item) {
+    std::uniform_int_distribution<size_t> pickCustomer(0, population.customerIds.size() - 1);
+    std::uniform_int_distribution<int> percent(0, 99);
+    size_t index = pickCustomer(rng);
+    item.customerId = population.customerIds[index];
+    item.repId = population.repOf[index];
+    int roll = percent(rng);
+    if (roll < config.readShare) {
+        item.op = ServiceOp::GetCustomer;
+    } else {
+        static const ServiceOp kRecordOps[] = {ServiceOp::RecordCall, ServiceOp::RecordEmail, ServiceOp::RecordMeeting};
+        item.op = kRecordOps[roll % 3];
+        item.content = "Load test interaction about the quarterly renewal";
+        item.detail = item.op == ServiceOp::RecordEmail ? "Renewal" : "Head office";
+        item.minutes = 15;
+    }
+}
+
+void LoadThread::fillRequests(LoadConnection& connection) {
+    while (connection.remaining > 0 && connection.inflight.size() < config.depth) {
+        size_t operations = std::min(config.batch, connection.remaining);
+        if (config.batch == 1) {
+            makeRequest(request);
+        } else {
+            request.op = ServiceOp::Batch;
+            request.batch.resize(operations);
+            for (size_t i = 0; i < operations; ++i) {
+                makeRequest(request.batch[i]);
+                request.batch[i].id = static_cast<uint32_t>(i);
+            }
+        }
+        request.id = static_cast<uint32_t>(connection.remaining);
+        encodeServiceRequest(request, connection.output);
+        connection.inflight.push_back(Clock::now());
+        connection.remaining -= operations;
+    }
+}
+
+bool LoadThread::flush(LoadConnection& connection) {
+    while (connection.outputOffset < connection.output.size()) {
+        ssize_t n = ::send(connection.fd, connection.output.data() + connection.outputOffset, 
+                           connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if (n > 0) {
+            connection.outputOffset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            setWriting(connection, true);
+            return true;
+        }
+        return false;
+    }
+    connection.output.clear();
+    connection.outputOffset = 0;
+    setWriting(connection, false);
+    return true;
+}
+
+void LoadThread::setWriting(LoadConnection& connection, bool writing) {
+    if (connection.writing == writing)
+        return;
+    epoll_event event{};
+    event.events = EPOLLIN | (writing ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    event.data.u64 = static_cast<uint64_t>(&connection - connections.data());
+    ::epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+    connection.writing = writing;
+}
+
+bool LoadThread::readResponses(LoadConnection& connection) {
+    char buffer[64 * 1024];
+    ssize_t n;
+    while ((n = ::recv(connection.fd, buffer, sizeof(buffer), 0)) > 0)
+        connection.input.append(buffer, static_cast<size_t>(n));
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        return false;
+    
+    auto now = Clock::now();
+    size_t offset = 0;
+    size_t frame;
+    while ((frame = serviceFrameSize(connection.input.data() + offset, connection.input.size() - offset)) != 0) {
+        if (frame == SIZE_MAX || connection.inflight.empty())
+            return false;
+        uint64_t errors = 0;
+        if (!decodeServiceResponse(connection.input.data() + offset + 4, frame - 4, response) ||
+            response.status != ServiceStatus::Ok)
+            errors++;
+        for (const auto& item : response.batch)
+            errors += item.status != ServiceStatus::Ok;
+        results.operations.fetch_add(response.op == ServiceOp::Batch ? response.batch.size() : 1, 
+                                     std::memory_order_relaxed);
+        results.errors.fetch_add(errors, std::memory_order_relaxed);
+        auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(now - connection.inflight.front());
+        results.latency.record(static_cast<uint64_t>(latency.count()));
+        connection.inflight.pop_front();
+        offset += frame;
+    }
+    connection.input.erase(0, offset);
+    return true;
+}
+
+void LoadThread::run() {
+    size_t active = 0;
+    for (auto& connection : connections) {
+        fillRequests(connection);
+        if (!flush(connection)) {
+            results.failed = true;
+            return;
+        }
+        if (!connection.inflight.empty())
+            active++;
+    }
+    
+    std::vector<epoll_event> events(std::min<size_t>(connections.size(), 1024));
+    while (active > 0) {
+        int ready = ::epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 1000);
+        if (ready < 0 && errno != EINTR) {
+            results.failed = true;
+            return;
+        }
+        for (int i = 0; i < ready; ++i) {
+            LoadConnection& connection = connections[events[i].data.u64];
+            bool ok = true;
+            if (events[i].events & EPOLLOUT)
+                ok = flush(connection);
+            if (ok && (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))) {
+                bool wasActive = !connection.inflight.empty();
+                ok = readResponses(connection);
+                if (ok) {
+                    fillRequests(connection);
+                    ok = flush(connection);
+                }
+                if (wasActive && connection.inflight.empty())
+                    active--;
+            }
+            if (!ok) {
+                results.failed = true;
+                return;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    LoadConfig config;
+    if (!parseArgs(argc, argv, config))
+        return 1;
+    raiseDescriptorLimit();
+    
+    Population population;
+    std::printf("Creating %zu customers and %zu reps on %s:%u...\n", config.customers, config.reps, 
+                config.host.c_str(), config.port);
+    if (!populate(config, population)) {
+        std::fprintf(stderr, "Setup failed\n");
+        return 1;
+    }
+    
+    LoadResults results;
+    std::vector<std::unique_ptr<LoadThread>> loadThreads;
+    for (size_t t = 0; t < config.threads; ++t) {
+        size_t count = config.connections / config.threads + (t < config.connections % config.threads ? 1 : 0);
+        size_t requests = config.requests / config.threads + (t < config.requests % config.threads ? 1 : 0);
+        loadThreads.push_back(std::make_unique<LoadThread>(config, population, results, config.seed + static_cast<unsigned>(t)));
+        if (!loadThreads.back()->connect(count, requests)) {
+            std::fprintf(stderr, "Could not open %zu connections\n", config.connections);
+            return 1;
+        }
+    }
+    
+    auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (auto& loadThread : loadThreads)
+        workers.emplace_back([&loadThread] { loadThread->run(); });
+    for (auto& worker : workers)
+        worker.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    
+    if (results.failed) {
+        std::fprintf(stderr, "A connection failed during the run\n");
+        return 1;
+    }
+    uint64_t count = results.latency.getCount();
+    uint64_t operations = results.operations.load();
+    std::printf("connections %zu  threads %zu  depth %zu  batch %zu  read share %d%%\n", config.connections, 
+                config.threads, config.depth, config.batch, config.readShare);
+    std::printf("%llu operations in %llu frames, %.2f s: %.0f ops/sec, %llu errors\n", 
+                static_cast<unsigned long long>(operations), static_cast<unsigned long long>(count), seconds, 
+                operations / seconds, static_cast<unsigned long long>(results.errors.load()));
+    std::printf("frame latency us  mean %.1f  p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+                count ? results.latency.getTotal() / 1e3 / count : 0.0,
+                results.latency.getPercentile(0.50) / 1e3, results.latency.getPercentile(0.90) / 1e3,
+                results.latency.getPercentile(0.99) / 1e3, results.latency.getPercentile(0.999) / 1e3,
+                results.latency.getMax() / 1e3);
+    return results.errors ? 1 : 0;
+}
@@ -0,0 +1,66 @@
+// Local admin endpoint for inspecting a running CRM
+// admin_server.h
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class CRM;
+
+// Admin server on a Unix domain socket
+// A background thread accepts one connection at a time, reads a single
+// command line, writes the response and closes the connection, so it can be
+// driven with e.g. `echo "memory" | nc -U /tmp/crm.sock`. Commands that read
+// the CRM take crmMutex, which the application must also hold while it
+// mutates the CRM; latency metrics are lock-free and never take it. Reports
+// hold it only to pin a snapshot (CRM::openReportSnapshot) and are built from
+// that, so a long report does not stall writers.
+//
+//   help                          list commands
+//   metrics [text|json]           per-operation latency histograms
+//   counts [json]                 customers per type
+//   memory [json]                 approximate bytes per subsystem
+//   report system|revenue|reps|top [k]
+class AdminServer {
+private:
+    static constexpr size_t kMaxCommand = 1024;
+    static constexpr int kPollMillis = 100;  // how quickly stop() is noticed
+    
+    CRM& crm;
+    std::mutex& crmMutex;
+    std::string socketPath;
+    int listenFd = -1;
+    std::atomic<bool> running{false};
+    std::thread worker;
+    
+    void run();
+    void serveConnection(int fd);
+    
+    std::string handleMetrics(const std::string& format) const;
+    std::string handleCounts(const std::string& format) const;
+    std::string handleMemory(const std::string& format) const;
+    std::string handleReport(const std::string& name, const std::string& argument) const;
+
+public:
+    AdminServer(CRM& crm, std::mutex& crmMutex) : crm(crm), crmMutex(crmMutex) {}
+    
+    ~AdminServer() { stop(); }
+    
+    AdminServer(const AdminServer&) = delete;
+    AdminServer& operator=(const AdminServer&) = delete;
+    
+    // Bind the socket (replacing a stale one at the same path) and start serving
+    bool start(const std::string& path);
+    
+    // Stop serving and remove the socket file
+    void stop();
+    
+    bool isRunning() const { return running.load(); }
+    const std::string& getSocketPath() const { return socketPath; }
+    
+    // Execute one command line and return the response text
+    std::string handleCommand(const std::string& line) const;
+};
@@ -0,0 +1,85 @@
+// Background worker pool for campaign actions
+// campaign_scheduler.h
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Worker pool that runs campaign actions in the background
+// Jobs are taken from a priority queue (lower value first, FIFO within a
+// priority), throttled by a token bucket when a rate limit is set, and
+// retried when they throw, up to maxAttempts times in total.
+class CampaignScheduler {
+public:
+    struct Stats {
+        uint64_t submitted;
+        uint64_t completed;
+        uint64_t failed;
+        uint64_t retried;
+        size_t queueDepth;
+        size_t maxQueueDepth;
+        double throughput;  // completed jobs per second since the first submit
+    };
+
+private:
+    struct Job {
+        int priority;
+        uint64_t sequence;
+        int attempts;
+        std::function<void()> action;
+    };
+    
+    struct JobOrder {
+        bool operator()(const Job& a, const Job& b) const {
+            return a.priority != b.priority ? a.priority > b.priority : a.sequence > b.sequence;
+        }
+    };
+    
+    mutable std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable idle;
+    std::priority_queue<Job, std::vector<Job>, JobOrder> queue;
+    std::vector<std::thread> workers;
+    bool stopping = false;
+    size_t active = 0;
+    uint64_t nextSequence = 0;
+    int maxAttempts;
+    
+    // Token bucket; a rate of zero means unlimited
+    double ratePerSecond;
+    double capacity;  // at least one token, so rates below one per second still run jobs
+    double tokens;
+    std::chrono::steady_clock::time_point lastRefill;
+    
+    Stats stats = {0, 0, 0, 0, 0, 0, 0.0};
+    std::chrono::steady_clock::time_point started;
+    
+    // Block until the rate limit allows another job (called without the lock held)
+    void acquireToken();
+    
+    void run();
+
+public:
+    explicit CampaignScheduler(size_t workerCount = 4, double maxActionsPerSecond = 0, int maxAttempts = 3);
+    
+    // Finishes queued jobs, then stops the workers
+    ~CampaignScheduler();
+    
+    CampaignScheduler(const CampaignScheduler&) = delete;
+    CampaignScheduler& operator=(const CampaignScheduler&) = delete;
+    
+    // Queue an action; lower priority values run first
+    void submit(int priority, std::function<void()> action);
+    
+    // Block until every queued job has finished
+    void wait();
+    
+    Stats getStats() const;
+};
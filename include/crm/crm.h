@@ -0,0 +1,376 @@
+// CRM system facade
+// crm.h
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "crm/customer.h"
+#include "crm/customer_history.h"
+#include "crm/customer_store.h"
+#include "crm/duplicate_detector.h"
+#include "crm/interaction_archive.h"
+#include "crm/interaction_index.h"
+#include "crm/loyalty_ledger.h"
+#include "crm/metrics.h"
+#include "crm/rep_load_balancer.h"
+#include "crm/report_versions.h"
+#include "crm/report_summary.h"
+#include "crm/sales_representative.h"
+#include "crm/scoring_rules.h"
+#include "crm/slot_map.h"
+
+// CRM class to manage the overall system
+class CRM : public CustomerObserver {
+private:
+    struct RepTag;
+    using RepHandle = Handle<RepTag>;
+    
+    CustomerRegistry customerStore;
+    SlotMap<SalesRepresentative, RepTag> repStore;
+    CustomerTable customers;
+    std::vector<RepHandle> salesReps;
+    int nextCustomerId;
+    int customerIdStride = 1;
+    int nextSalesRepId;
+    std::unordered_map<int, RepHandle> salesRepsById;
+    RepLoadBalancer repLoads;
+    InteractionIndex interactionIndex;
+    InteractionArchive interactionArchive;
+    LoyaltyLedger loyaltyLedger;
+    ScoringRules scoringRules;
+    DuplicateDetector duplicateDetector;
+    mutable ReportVersions reportVersions;  // opening a snapshot leaves the figures unchanged
+    CustomerHistory customerHistory;
+    std::function<time_t()> historyClock = [] { return time(nullptr); };
+    
+    // Annual contract value, maintained incrementally system-wide and per rep
+    int64_t totalContractCents = 0;
+    std::unordered_map<int, int64_t> repContractCents;
+    
+    // Customers ordered by total interaction time (highest first, then by id),
+    // maintained as interactions are recorded so top-K needs no full sort
+    struct RankingOrder {
+        bool operator()(const std::pair<int, int>& a, const std::pair<int, int>& b) const {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        }
+    };
+    std::set<std::pair<int, int>, RankingOrder> interactionRanking;  // (total time, customer id)
+    std::unordered_map<int, int> rankedTimes;                         // customer id -> total time
+    
+    void updateRanking(int customerId, int totalTime);
+    
+    // While a batch is recorded, customers whose interaction time changed are
+    // collected here and re-ranked once at the end instead of per interaction
+    bool deferRanking = false;
+    std::vector<int> rankingDirty;
+    
+    // Find a customer by id
+    CustomerHandle findCustomerHandle(int customerId) const;
+    
+    Customer* findCustomer(int customerId) { return customerStore.get(findCustomerHandle(customerId)); }
+    const Customer* findCustomer(int customerId) const { return customerStore.get(findCustomerHandle(customerId)); }
+    
+    // Find a sales rep by id
+    SalesRepresentative* findSalesRep(int repId);
+    
+    // Take a customer out of its current rep's portfolio, if any
+    void detachFromRep(Customer* customer);
+    
+    // Move a customer into a rep's portfolio, taking it out of its current one
+    void moveCustomer(CustomerHandle handle, SalesRepresentative* rep);
+    
+    // Contract values are totalled in integer cents so incremental updates never drift
+    static int64_t toCents(double amount) { return static_cast<int64_t>(std::llround(amount * 100)); }
+    
+    int64_t contractCentsOf(int customerId) const;
+    
+    // Group customers of one kind by their interned group id, touching only integer columns
+    std::map<std::string, int> countByGroup(CustomerKind kind) const;
+    
+    // Turn interned-id counts into counts keyed by the string values
+    static std::map<std::string, int> resolveGroups(const std::unordered_map<uint32_t, int>& counts);
+    
+    // Set a customer's interaction multiplier from this CRM's scoring rules
+    void applyScoringRules(Customer& customer) const;
+    
+    // Register a newly created customer with the CRM
+    void registerCustomer(CustomerHandle handle);
+    
+    // Update a customer table column together with its report version and history;
+    // repSlot is the customer's position in the new rep's portfolio
+    void setTableRepId(int customerId, int repId, size_t repSlot = 0);
+    void setTableInteractionTime(int customerId, int minutes);
+    
+    int takeCustomerId() {
+        int id = nextCustomerId;
+        nextCustomerId += customerIdStride;
+        return id;
+    }
+
+public:
+    CRM();
+    
+    // Customers and reps hold pointers back into the CRM, so it must stay in place
+    CRM(const CRM&) = delete;
+    CRM& operator=(const CRM&) = delete;
+    
+    // Keep the interaction index up to date (CustomerObserver)
+    void onInteractionAdded(const Customer& customer, const Interaction& interaction) override;
+    
+    // Mirror type-specific fields into the customer table (CustomerObserver)
+    void onCustomerUpdated(const Customer& customer) override;
+    
+    // Hand out customer ids firstId, firstId + stride, ... so that several CRMs
+    // (e.g. the shards of a partitioned deployment) never reuse each other's
+    // ids. Only allowed once, before the first customer is created.
+    bool setCustomerIdSpace(int firstId, int stride);
+    
+    // Customer and sales rep pointers returned by the create methods stay valid
+    // until that customer or rep is removed from the CRM
+    
+    // Create a regular customer
+    RegularCustomer* createRegularCustomer(
+        const std::string& name, const std::string& email, 
+        const std::string& phone, const std::string& segment);
+    
+    // Create a VIP customer
+    VIPCustomer* createVIPCustomer(
+        const std::string& name, const std::string& email, 
+        const std::string& phone, const std::string& accountManager);
+    
+    // Create a corporate customer
+    CorporateCustomer* createCorporateCustomer(
+        const std::string& name, const std::string& email, 
+        const std::string& phone, const std::string& companyName,
+        int numberOfEmployees, double annualContract);
+    
+    // Create a sales representative
+    SalesRepresentative* createSalesRepresentative(const std::string& name);
+    
+    // Look up a customer by id (nullptr if unknown)
+    const Customer* getCustomer(int customerId) const {
+        OperationTimer timer(Operation::GetCustomer);
+        return findCustomer(customerId);
+    }
+    
+    // Look up a sales rep by id (nullptr if unknown)
+    SalesRepresentative* getSalesRepresentative(int repId) {
+        OperationTimer timer(Operation::GetSalesRepresentative);
+        return findSalesRep(repId);
+    }
+    
+    // A customer's rep, loyalty points and contract value as they were at the
+    // given time, even if it has since been removed; false if it did not exist then
+    bool getCustomerAsOf(int customerId, time_t at, CustomerHistory::Version& version) const;
+    
+    // Source of the timestamps on customer history (the wall clock by default),
+    // e.g. to replay an import with its original dates
+    void setHistoryClock(std::function<time_t()> clock) { historyClock = std::move(clock); }
+    
+    // Every customer, ordered by id
+    std::vector<const Customer*> getCustomers() const;
+    
+    // Every sales rep, in creation order
+    std::vector<const SalesRepresentative*> getSalesRepresentatives() const;
+    
+    // Assign a customer to a sales representative
+    void assignCustomerToRep(int customerId, int repId);
+    
+    // Assign a customer to the least loaded sales rep, returning the rep id (0 if none)
+    int autoAssignCustomer(int customerId);
+    
+    // Age the recent-minutes component of rep workloads
+    void decayRepWorkloads(double factor) {
+        OperationTimer timer(Operation::DecayRepWorkloads);
+        repLoads.decayRecentMinutes(factor);
+    }
+    
+    // Move customers from the largest to the smallest portfolios until they are within
+    // one customer of each other, e.g. after a new rep joins. Returns the number moved.
+    size_t rebalanceCustomers();
+    
+    // Remove a sales rep, handing its customers to the least loaded remaining reps
+    void removeSalesRepresentative(int repId);
+    
+    // Move a customer to another rep without printing, returning false if either is unknown
+    bool reassignCustomer(int customerId, int newRepId);
+    
+    // Apply many (customer id, new rep id) moves at once, e.g. a territory reshuffle.
+    // Each move is O(1); returns the number of moves applied.
+    size_t reassignCustomers(const std::vector<std::pair<int, int>>& moves);
+    
+    // Take a customer out of its rep's portfolio, leaving it unassigned
+    void unassignCustomer(int customerId);
+    
+    // Remove a customer from the CRM and every index. The last customer takes the
+    // removed one's place, so listing order is not preserved.
+    bool removeCustomer(int customerId);
+    
+    // Display all customers
+    void displayAllCustomers() const;
+    
+    // Display all sales representatives
+    void displayAllSalesReps() const;
+    
+    // Ids of customers of the given kind whose interaction time is at least minMinutes
+    std::vector<int> filterCustomers(CustomerKind kind, int minMinutes) const;
+    
+    // Total loyalty points held by VIP customers
+    double getTotalLoyaltyPoints() const;
+    
+    // Compress interaction content older than the given number of days; returns bytes saved
+    size_t compressInteractionsOlderThan(int days);
+    
+    // Load scoring rules from a config file for this CRM and re-resolve every customer's multiplier
+    bool loadScoringRules(const std::string& path);
+    
+    // Grant loyalty points to a VIP customer through the ledger
+    bool addLoyaltyPoints(int customerId, double points, LoyaltyReason reason = LoyaltyReason::Manual);
+    
+    // Commit pending loyalty accruals so balances are up to date
+    void commitLoyaltyPoints() {
+        OperationTimer timer(Operation::CommitLoyaltyPoints);
+        loyaltyLedger.commit();
+    }
+    
+    // Loyalty points granted through the ledger, including pending accruals
+    double getLoyaltyBalance(int customerId);
+    
+    // Audit trail of a customer's loyalty accruals
+    std::vector<LoyaltyLedger::Entry> getLoyaltyHistory(int customerId);
+    
+    // Apply many contract renewals at once, e.g. at fiscal year-end.
+    // Returns the number of corporate customers renewed.
+    struct ContractRenewal {
+        int customerId;
+        double amount;
+        time_t effectiveDate;
+    };
+    
+    size_t renewContracts(const std::vector<ContractRenewal>& renewals);
+    
+    // Total annual contract value across all corporate customers
+    double getAnnualContractValue() const {
+        OperationTimer timer(Operation::GetAnnualContractValue);
+        return static_cast<double>(totalContractCents) / 100;
+    }
+    
+    // Annual contract value of the corporate customers assigned to a rep
+    double getAnnualContractValue(int repId) const;
+    
+    // Print annual contract value per sales rep and in total, from a report snapshot
+    void generateRevenueReport(std::ostream& out = std::cout) const;
+    
+    // Queue customer-specific actions for every assigned customer (see
+    // SalesRepresentative::scheduleCustomerActions for ordering and constraints)
+    void scheduleCampaign(CampaignScheduler& scheduler, std::ostream& out = std::cout) const;
+    
+    // Start spilling old interactions to an append-only segment file (once per CRM)
+    bool enableInteractionTiering(const std::string& segmentPath);
+    
+    // Spill interactions older than the given number of days to disk; returns the number
+    // spilled. A customer whose interactions cannot be written keeps them in memory.
+    size_t spillInteractionsOlderThan(int days);
+    
+    // Record many interactions at once, e.g. a batch received over the network.
+    // Consecutive records for the same rep are handed to it as one run, and
+    // rankings are refreshed once per customer. Sets recorded[i] for each record
+    // (false if the rep is unknown or the customer is not in its portfolio).
+    size_t recordInteractions(const std::vector<InteractionRecord>& records, std::vector<bool>& recorded);
+    
+    // Number of regular customers per segment
+    std::map<std::string, int> countCustomersBySegment() const {
+        OperationTimer timer(Operation::CountCustomersBySegment);
+        return countByGroup(CustomerKind::Regular);
+    }
+    
+    // Number of VIP customers per account manager
+    std::map<std::string, int> countCustomersByAccountManager() const {
+        OperationTimer timer(Operation::CountCustomersByAccountManager);
+        return countByGroup(CustomerKind::VIP);
+    }
+    
+    // Number of meetings held at each location
+    std::map<std::string, int> countMeetingsByLocation() const;
+    
+    // Full-text search over interaction content, email subjects and meeting locations
+    std::vector<InteractionIndex::Hit> searchInteractions(const std::string& query) const {
+        OperationTimer timer(Operation::SearchInteractions);
+        return interactionIndex.search(query);
+    }
+    
+    // Print the interactions matching a search query
+    void displaySearchResults(const std::string& query) const;
+    
+    // The k customers with the highest total interaction time (multipliers applied)
+    std::vector<const Customer*> getTopCustomersByInteractionTime(size_t k) const;
+    
+    // Print the top customers by total interaction time
+    void displayTopCustomers(size_t k, std::ostream& out = std::cout) const;
+    
+    // Candidate duplicate customer pairs across all customer types
+    std::vector<DuplicateDetector::Candidate> findDuplicateCustomers(double threshold = 0.6) const {
+        OperationTimer timer(Operation::FindDuplicateCustomers);
+        return duplicateDetector.findCandidatePairs(threshold);
+    }
+    
+    // Existing customers that look like the given details, e.g. before creating a new one
+    std::vector<DuplicateDetector::Candidate> findPossibleDuplicates(
+        const std::string& name, const std::string& email, 
+        const std::string& phone, double threshold = 0.6) const;
+    
+    // Number of customers of each type, keyed by type name
+    std::map<std::string, int> countCustomersByType() const;
+    
+    // Approximate bytes held by each subsystem
+    struct MemoryUsage {
+        size_t customers;          // customer objects and their fields
+        size_t interactions;       // resident interactions and their content
+        size_t customerTable;      // hot-field columns and row map
+        size_t interactionIndex;
+        size_t duplicateDetector;
+        size_t loyaltyLedger;
+        size_t ranking;            // top-customer ordering
+        size_t reportVersions;     // report fields, including versions kept for open snapshots
+        size_t customerHistory;    // point-in-time versions, including removed customers
+        size_t salesReps;
+        size_t stringPool;         // shared by every CRM in the process
+        size_t archivedOnDisk;     // spilled interactions, not held in memory
+        
+        size_t total() const {
+            return customers + interactions + customerTable + interactionIndex + 
+                   duplicateDetector + loyaltyLedger + ranking + reportVersions + customerHistory + 
+                   salesReps + stringPool;
+        }
+    };
+    
+    MemoryUsage getMemoryUsage() const;
+    
+    // Figures behind the system-wide reports, with the topK customers by interaction
+    // time and, if withRepCustomers is set, every rep's customers in portfolio order
+    ReportSummary getReportSummary(size_t topK, bool withRepCustomers) const;
+    
+    // Pin a consistent view of the report figures. Opening it is cheap (a copy
+    // of one pointer per few hundred customers) and needs the same exclusion as
+    // any other CRM call, but the snapshot can then be summarized on another
+    // thread without it while the CRM keeps changing. Release every snapshot
+    // before the CRM is destroyed.
+    ReportVersions::Snapshot openReportSnapshot() const;
+    
+    // Print every sales rep's interaction time report, from a report snapshot
+    void generateInteractionTimeReports(std::ostream& out = std::cout) const;
+    
+    // Generate system-wide report from a report snapshot
+    void generateSystemReport(std::ostream& out = std::cout) const;
+};
@@ -0,0 +1,64 @@
+// Blocking client for the CRM service protocol
+// crm_client.h
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "crm/service_protocol.h"
+
+// Blocking TCP client for a CrmServer
+// Requests can be pipelined: queue several with send(), then read the
+// responses back in the same order with receive(). With a timeout set, the
+// socket is non-blocking and connect(), flush() and receive() each fail once
+// the timeout has passed instead of waiting on a server that does not answer.
+class CrmClient {
+private:
+    using Deadline = std::chrono::steady_clock::time_point;
+    
+    int fd = -1;
+    uint32_t nextId = 1;
+    int timeoutMs = 0;  // 0 blocks without limit
+    std::string output;
+    std::string input;
+    size_t inputOffset = 0;  // bytes of input already decoded
+    
+    Deadline deadlineFromNow() const {
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    }
+    
+    // Wait until the socket is ready for the poll events; false once the deadline passes
+    bool waitReady(short events, Deadline deadline) const;
+
+public:
+    CrmClient() = default;
+    
+    ~CrmClient() { close(); }
+    
+    CrmClient(const CrmClient&) = delete;
+    CrmClient& operator=(const CrmClient&) = delete;
+    
+    // Limit each connect, flush and receive to the given time; applies from the next connect
+    void setTimeout(int milliseconds) { timeoutMs = milliseconds; }
+    
+    // Connect to a server on an IPv4 address
+    bool connect(const std::string& host, uint16_t port);
+    
+    void close();
+    
+    bool isConnected() const { return fd >= 0; }
+    
+    // Queue a request without sending it, assigning and returning its id
+    uint32_t send(ServiceRequest request);
+    
+    // Send every queued request
+    bool flush();
+    
+    // Flush, then wait for the next response; false if the connection failed
+    bool receive(ServiceResponse& response);
+    
+    // Send one request and wait for its response
+    bool call(const ServiceRequest& request, ServiceResponse& response);
+};
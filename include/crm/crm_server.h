@@ -0,0 +1,123 @@
+// Network server exposing the CRM service protocol
+// crm_server.h
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "crm/crm_service.h"
+
+class CRM;
+class ReplicationLog;
+
+// TCP server for the CRM service protocol (see service_protocol.h)
+// A single background thread runs an epoll event loop over non-blocking
+// sockets, so thousands of idle or pipelining clients cost one buffer pair
+// each rather than a thread. All complete frames read from a connection in
+// one go are executed under a single acquisition of crmMutex, which the
+// application must also hold while it uses the CRM from other threads (the
+// AdminServer takes the same mutex). A connection whose unsent responses pile
+// up past kMaxPendingOutput is not read from until the client catches up.
+//
+// With a replication log attached, a Subscribe request turns its connection
+// into a follower: after the snapshot, every newly logged mutation is copied
+// into its output, again only while less than kMaxPendingOutput is unsent.
+// A follower that falls further behind than the log retains is dropped.
+class CrmServer {
+private:
+    static constexpr size_t kReadChunk = 64 * 1024;
+    static constexpr size_t kMaxPendingOutput = 8 * 1024 * 1024;
+    static constexpr int kMaxEvents = 256;
+    
+    struct Connection {
+        int fd;
+        std::string input;
+        std::string output;
+        size_t outputOffset = 0;  // bytes of output already sent
+        bool reading = true;      // EPOLLIN is registered
+        bool writing = false;     // EPOLLOUT is registered
+        bool peerClosed = false;  // close once the output is flushed
+        bool follower = false;    // subscribed to the replication log
+        uint64_t nextSequence = 0;  // next log entry to send a follower
+    };
+    
+    std::mutex& crmMutex;
+    std::unique_ptr<CrmService> service;  // null when serving another handler
+    ServiceHandler* handler;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;
+    uint16_t port = 0;
+    std::atomic<bool> running{false};
+    std::atomic<size_t> connectionCount{0};
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    ReplicationLog* log = nullptr;
+    std::vector<int> followers;
+    std::thread worker;
+    
+    void run();
+    void acceptConnections();
+    void handleReadable(Connection& connection);
+    
+    // Copy newly logged mutations into the output of every follower
+    void shipLog();
+    
+    // Send as much pending output as the socket takes; false if the connection failed
+    bool flushOutput(Connection& connection);
+    
+    // Register EPOLLIN/EPOLLOUT interest to match the connection's buffers
+    void updateInterest(Connection& connection);
+    
+    void closeConnection(int fd);
+    void closeAll();
+
+public:
+    CrmServer(CRM& crm, std::mutex& crmMutex) 
+        : crmMutex(crmMutex), service(std::make_unique<CrmService>(crm)), handler(service.get()) {}
+    
+    // Serve frames with another handler, e.g. a ShardRouter; crmMutex is held
+    // around each call to it
+    CrmServer(ServiceHandler& handler, std::mutex& crmMutex) : crmMutex(crmMutex), handler(&handler) {}
+    
+    ~CrmServer() { stop(); }
+    
+    CrmServer(const CrmServer&) = delete;
+    CrmServer& operator=(const CrmServer&) = delete;
+    
+    // Log every mutation and serve Subscribe requests from it; call before start().
+    // Only for a server of a local CRM.
+    void setReplicationLog(ReplicationLog* newLog) {
+        if (!service)
+            return;
+        log = newLog;
+        service->setReplicationLog(newLog);
+    }
+    
+    // Answer mutating requests with ReadOnly; call before start(). Only for a
+    // server of a local CRM.
+    void setReadOnly(bool value) {
+        if (service)
+            service->setReadOnly(value);
+    }
+    
+    // Listen on an IPv4 address; port 0 picks a free port (see getPort)
+    bool start(const std::string& host, uint16_t listenPort);
+    
+    // Stop the event loop and close every connection
+    void stop();
+    
+    bool isRunning() const { return running.load(); }
+    uint16_t getPort() const { return port; }
+    size_t getConnectionCount() const { return connectionCount.load(); }
+};
+
+// Lift the process's soft descriptor limit to the hard one; every connection
+// needs a descriptor
+void raiseDescriptorLimit();
@@ -0,0 +1,81 @@
+// Executes CRM service protocol requests
+// crm_service.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "crm/sales_representative.h"
+#include "crm/service_protocol.h"
+
+class CRM;
+class ReplicationLog;
+
+// Answers a stream of request frames with response frames (see CrmServer)
+class ServiceHandler {
+public:
+    virtual ~ServiceHandler() = default;
+    
+    // Handle every complete request frame at the front of the input, appending
+    // one response frame per request in order. Returns the number of bytes
+    // consumed, or SIZE_MAX if a frame is oversized and the stream must be dropped.
+    // When a Subscribe request succeeds, handling stops after it and followFrom
+    // is set to the first log sequence to ship to the connection.
+    virtual size_t handleFrames(const char* data, size_t size, std::string& output, uint64_t* followFrom) = 0;
+};
+
+// Maps decoded service requests onto the CRM API
+// Not thread-safe: the caller serializes access to the CRM and to the service.
+class CrmService : public ServiceHandler {
+private:
+    CRM& crm;
+    ReplicationLog* log = nullptr;
+    bool readOnly = false;
+    
+    // Reused across frames so their string fields keep their capacity
+    ServiceRequest request;
+    ServiceResponse response;
+    std::vector<InteractionRecord> records;
+    std::vector<bool> recorded;
+    std::string snapshot;
+    
+    static bool isRecordOp(ServiceOp op) {
+        return op == ServiceOp::RecordCall || op == ServiceOp::RecordEmail || op == ServiceOp::RecordMeeting;
+    }
+    
+    // Execute the items of a batch; runs of record requests go through
+    // CRM::recordInteractions in one call
+    void executeBatch(const std::vector<ServiceRequest>& items, std::vector<ServiceResponse>& responses);
+    
+    // Answer a Subscribe request, following it with the snapshot if one was asked for.
+    // Returns the sequence the follower needs next, or 0 if it cannot be served.
+    uint64_t subscribe(const ServiceRequest& request, std::string& output);
+
+public:
+    explicit CrmService(CRM& crm) : crm(crm) {}
+    
+    // Append every successful mutation to a log for read replicas
+    void setReplicationLog(ReplicationLog* newLog) { log = newLog; }
+    
+    // Reject mutating requests, e.g. on a read replica
+    void setReadOnly(bool value) { readOnly = value; }
+    
+    // Write request frames that rebuild the CRM's current state on an empty CRM:
+    // reps, customers, assignments, then every interaction through the
+    // customer's current rep. Interaction timestamps are not carried over.
+    // Assumes no ids were skipped, as holds when the CRM has only been changed
+    // through the service, and that the target CRM has the same customer id
+    // space (CRM::setCustomerIdSpace). Returns the number of frames written.
+    uint32_t writeSnapshot(std::string& out) const;
+    
+    // Execute one request, filling in the response
+    void execute(const ServiceRequest& request, ServiceResponse& response);
+    
+    // Handle request frames (see ServiceHandler); a Subscribe request is only
+    // served when followFrom is given
+    size_t handleFrames(const char* data, size_t size, std::string& output, 
+                        uint64_t* followFrom = nullptr) override;
+};
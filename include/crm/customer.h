@@ -0,0 +1,218 @@
+// Customer class hierarchy
+// customer.h
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "crm/interaction.h"
+#include "crm/interaction_archive.h"
+#include "crm/kinds.h"
+#include "crm/logger.h"
+#include "crm/string_pool.h"
+
+class Customer;
+
+// Observer notified when a customer changes, used to keep CRM indexes in sync (Abstraction)
+class CustomerObserver {
+public:
+    virtual ~CustomerObserver() = default;
+    
+    // Called after an interaction has been appended to the customer
+    virtual void onInteractionAdded(const Customer& customer, const Interaction& interaction) = 0;
+    
+    // Called after type-specific fields (loyalty points, contract value) have changed
+    virtual void onCustomerUpdated(const Customer& customer) = 0;
+};
+
+// Abstract base class for Customer (Abstraction)
+class Customer {
+protected:
+    int id;
+    std::string name;
+    std::string email;
+    std::string phone;
+    std::vector<std::unique_ptr<Interaction>> interactions;  // resident (newest) interactions
+    std::string type;
+    CustomerKind kind;
+    CustomerObserver* observer = nullptr;
+    int totalDuration = 0;  // running sum of interaction durations
+    double interactionMultiplier;  // resolved from the scoring rules
+    int repId = 0;          // assigned sales rep, 0 when unassigned
+    
+    // Oldest interactions spilled to disk; they precede the resident ones
+    struct ArchivedInteraction {
+        uint64_t offset;
+        time_t timestamp;
+    };
+    std::vector<ArchivedInteraction> archived;
+    InteractionArchive* archive = nullptr;
+    
+    // Load an interaction by ordinal: archived ones are read back from disk
+    std::unique_ptr<Interaction> loadArchived(size_t ordinal) const {
+        return archive ? archive->read(archived[ordinal].offset) : nullptr;
+    }
+
+public:
+    // Constructor
+    Customer(int id, const std::string& name, const std::string& email, const std::string& phone,
+             CustomerKind kind);
+    
+    // Virtual destructor
+    virtual ~Customer() = default;
+    
+    // Add interaction (the customer takes ownership)
+    void addInteraction(std::unique_ptr<Interaction> interaction);
+    
+    // Let the observer know that type-specific fields changed
+    void notifyUpdated() const;
+    
+    // Attach the observer that is notified of changes (at most one)
+    void setObserver(CustomerObserver* newObserver) { observer = newObserver; }
+    
+    // Set the interaction-time multiplier (maintained by the CRM when rules change)
+    void setInteractionMultiplier(double multiplier) { interactionMultiplier = multiplier; }
+    
+    // Record which sales rep the customer is assigned to (maintained by the CRM)
+    void setRepId(int newRepId) { repId = newRepId; }
+    
+    // Set the archive that old interactions are spilled to
+    void setArchive(InteractionArchive* newArchive) { archive = newArchive; }
+    
+    // Move interactions recorded before the cutoff to the archive, keeping totals in memory.
+    // Returns the number of interactions spilled; if the archive cannot be written
+    // none are, and they stay resident.
+    size_t spillInteractions(time_t olderThan);
+    
+    // Visit interactions recorded in [from, to] in order, paging archived ones back from disk
+    void forEachInteractionBetween(time_t from, time_t to, 
+                                   const std::function<void(const Interaction&)>& visit) const;
+    
+    // Visit every interaction, including archived ones
+    void forEachInteraction(const std::function<void(const Interaction&)>& visit) const;
+    
+    // Display interactions
+    void displayInteractions() const;
+    
+    // Display interactions recorded in [from, to]
+    void displayInteractionsBetween(time_t from, time_t to) const;
+    
+    // Display one interaction by its ordinal in the customer's history
+    void displayInteraction(size_t ordinal) const;
+    
+    // Compress the content of interactions recorded before the cutoff; returns bytes saved
+    size_t compressInteractions(time_t olderThan);
+    
+    // Pure virtual method for customer-specific actions (Abstraction)
+    virtual void performCustomerSpecificAction(std::ostream& out = std::cout) const = 0;
+    
+    // Getters (Encapsulation)
+    int getId() const { return id; }
+    std::string getName() const { return name; }
+    std::string getEmail() const { return email; }
+    std::string getPhone() const { return phone; }
+    std::string getType() const { return type; }
+    CustomerKind getKind() const { return kind; }
+    int getRepId() const { return repId; }
+    // Interactions still held in memory (the most recent ones)
+    const std::vector<std::unique_ptr<Interaction>>& getInteractions() const { return interactions; }
+    size_t getInteractionCount() const { return archived.size() + interactions.size(); }
+    size_t getArchivedInteractionCount() const { return archived.size(); }
+    
+    // Approximate heap bytes held by the customer's fields, excluding interactions
+    size_t getMemoryUsage() const;
+    
+    // Approximate bytes held by the resident interactions
+    size_t getInteractionMemoryUsage() const;
+    
+    // Calculate total interaction time, weighted by the customer's multiplier
+    // (VIP and corporate boosts come from the scoring rules)
+    int calculateTotalInteractionTime() const {
+        return static_cast<int>(totalDuration * interactionMultiplier);
+    }
+    
+    double getInteractionMultiplier() const { return interactionMultiplier; }
+};
+
+// Derived class for Regular Customer (Inheritance)
+class RegularCustomer : public Customer {
+private:
+    InternedString segment;
+
+public:
+    RegularCustomer(int id, const std::string& name, const std::string& email, 
+                    const std::string& phone, const std::string& segment)
+        : Customer(id, name, email, phone, CustomerKind::Regular), segment(segment) {}
+    
+    // Implementation of pure virtual method (Polymorphism)
+    void performCustomerSpecificAction(std::ostream& out = std::cout) const override;
+    
+    // Getter
+    std::string getSegment() const { return segment; }
+    uint32_t getSegmentId() const { return segment.getId(); }
+};
+
+// Derived class for VIP Customer (Inheritance)
+class VIPCustomer : public Customer {
+private:
+    InternedString accountManager;
+    double loyaltyPoints;
+
+public:
+    VIPCustomer(int id, const std::string& name, const std::string& email, 
+                const std::string& phone, const std::string& accountManager);
+    
+    // Implementation of pure virtual method (Polymorphism)
+    void performCustomerSpecificAction(std::ostream& out = std::cout) const override;
+    
+    void addLoyaltyPoints(double points);
+    
+    // Apply points committed by the loyalty ledger (no message, the ledger is the record)
+    void applyLedgerPoints(double points);
+    
+    // Getters
+    std::string getAccountManager() const { return accountManager; }
+    uint32_t getAccountManagerId() const { return accountManager.getId(); }
+    double getLoyaltyPoints() const { return loyaltyPoints; }
+};
+
+// Derived class for Corporate Customer (Inheritance)
+class CorporateCustomer : public Customer {
+public:
+    // One contract term: the annual amount and when it took effect
+    struct ContractRecord {
+        double amount;
+        time_t effectiveDate;
+    };
+
+private:
+    std::string companyName;
+    int numberOfEmployees;
+    double annualContract;
+    std::vector<ContractRecord> contractHistory;
+
+public:
+    CorporateCustomer(int id, const std::string& name, const std::string& email, 
+                     const std::string& phone, const std::string& companyName, 
+                     int numberOfEmployees, double annualContract);
+    
+    // Implementation of pure virtual method (Polymorphism)
+    void performCustomerSpecificAction(std::ostream& out = std::cout) const override;
+    
+    void renewContract(double newAmount);
+    
+    // Renew without printing, recording the new term in the contract history
+    void applyRenewal(double newAmount, time_t effectiveDate);
+    
+    // Getters
+    std::string getCompanyName() const { return companyName; }
+    int getNumberOfEmployees() const { return numberOfEmployees; }
+    double getAnnualContract() const { return annualContract; }
+    const std::vector<ContractRecord>& getContractHistory() const { return contractHistory; }
+};
@@ -0,0 +1,71 @@
+// Point-in-time history of audited customer fields
+// customer_history.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <unordered_map>
+#include <vector>
+
+// Versions of each customer's sales rep, loyalty points and contract value
+// A change is stored as one (time, value) entry for the field that changed
+// only, so every version shares the fields it did not touch with the versions
+// before it instead of copying the record. Each field's entries are in time
+// order, which makes reading an account as of any moment one binary search per
+// field. Changes stamped with the same second collapse into one entry, so a
+// burst of updates (e.g. a loyalty commit) costs at most one version per
+// second. Histories outlive the customer so closed accounts can still be
+// audited.
+class CustomerHistory {
+public:
+    enum class Field : uint8_t { RepId, LoyaltyPoints, ContractValue };
+    static constexpr int kFieldCount = 3;
+    
+    // A customer as it was at some point in time
+    struct Version {
+        int repId = 0;
+        double loyaltyPoints = 0;   // VIP only
+        double annualContract = 0;  // Corporate only
+    };
+
+private:
+    struct Change {
+        time_t at;
+        int64_t value;  // rep id, thousandths of a point or cents
+    };
+    
+    struct Timeline {
+        time_t created;
+        time_t removed;
+        std::vector<Change> fields[kFieldCount];  // no entries means the field was always 0
+    };
+    
+    std::unordered_map<int, Timeline> timelines;
+    size_t changeCount = 0;
+    
+    // Latest value of a field at or before the given time
+    static int64_t valueAt(const std::vector<Change>& changes, time_t at);
+
+public:
+    // Start a customer's history; its fields start at 0
+    void addCustomer(int customerId, time_t at);
+    
+    // Close a customer's history, keeping it for audits
+    void removeCustomer(int customerId, time_t at);
+    
+    // Record a field's new value (rep id, thousandths of a point or cents).
+    // Unchanged values are skipped. A time earlier than the field's last change
+    // is treated as that time, so a clock stepping back never reorders history.
+    void record(int customerId, Field field, int64_t value, time_t at);
+    
+    // The customer as of the given time; false if it did not exist then
+    bool getVersion(int customerId, time_t at, Version& version) const;
+    
+    size_t getCustomerCount() const { return timelines.size(); }
+    size_t getChangeCount() const { return changeCount; }
+    
+    // Approximate heap bytes held by the timelines
+    size_t getMemoryUsage() const;
+};
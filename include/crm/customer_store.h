@@ -0,0 +1,126 @@
+// Customer storage: the slot-map registry and the structure-of-arrays table
+// customer_store.h
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "crm/customer.h"
+#include "crm/slot_map.h"
+
+// Storage for all customers
+// Every concrete customer type shares one slot map of variants, so customers
+// sit in contiguous blocks and are referred to by 32-bit CustomerHandles.
+using CustomerVariant = std::variant<RegularCustomer, VIPCustomer, CorporateCustomer>;
+struct CustomerTag;
+using CustomerHandle = Handle<CustomerTag>;
+
+class CustomerRegistry {
+private:
+    SlotMap<CustomerVariant, CustomerTag> slots;
+
+public:
+    // Create a customer of type T in place
+    template <typename T, typename... Args>
+    T* create(CustomerHandle& handle, Args&&... args) {
+        handle = slots.emplace(std::in_place_type<T>, std::forward<Args>(args)...);
+        return &std::get<T>(*slots.get(handle));
+    }
+    
+    // Resolve a handle, returning nullptr if the customer no longer exists
+    Customer* get(CustomerHandle handle);
+    
+    const Customer* get(CustomerHandle handle) const {
+        return const_cast<CustomerRegistry*>(this)->get(handle);
+    }
+    
+    bool erase(CustomerHandle handle) { return slots.erase(handle); }
+    size_t size() const { return slots.size(); }
+    size_t getMemoryUsage() const { return slots.getMemoryUsage(); }
+};
+
+// Structure-of-arrays table of customer hot fields
+// Each column is a separate array indexed by row, so scans such as reports
+// and filters only touch the columns they read. Names and emails live in a
+// separate string arena. Rows are swap-removed, so row order is insertion
+// order until the first removal.
+class CustomerTable {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+private:
+    struct StringRef {
+        uint32_t offset;
+        uint32_t length;
+    };
+    
+    // Hot columns
+    std::vector<int> ids;
+    std::vector<CustomerKind> kinds;
+    std::vector<CustomerHandle> handles;
+    std::vector<int> repIds;
+    std::vector<int> interactionTimes;   // with type multipliers applied
+    std::vector<double> loyaltyPoints;   // VIP only, 0 otherwise
+    std::vector<double> contractValues;  // Corporate only, 0 otherwise
+    std::vector<uint32_t> groupIds;      // interned segment (Regular) or account manager (VIP)
+    
+    // Cold columns
+    std::vector<StringRef> names;
+    std::vector<StringRef> emails;
+    std::string arena;
+    size_t arenaGarbage = 0;
+    
+    std::unordered_map<int, uint32_t> rows;  // customer id -> row
+    
+    StringRef store(const std::string& text);
+    
+    std::string_view view(StringRef ref) const {
+        return std::string_view(arena.data() + ref.offset, ref.length);
+    }
+    
+    // Rewrite the arena without the strings of removed rows
+    void compactArena();
+    
+    template <typename Column>
+    static void moveLast(Column& column, uint32_t row) {
+        column[row] = column.back();
+        column.pop_back();
+    }
+
+public:
+    // Append a row for a newly registered customer
+    void add(const Customer& customer, CustomerHandle handle);
+    
+    // Remove a customer's row, moving the last row into its place
+    void remove(int customerId);
+    
+    // Row of a customer, or npos
+    uint32_t find(int customerId) const;
+    
+    void setRepId(uint32_t row, int repId) { repIds[row] = repId; }
+    void setInteractionTime(uint32_t row, int minutes) { interactionTimes[row] = minutes; }
+    void setLoyaltyPoints(uint32_t row, double points) { loyaltyPoints[row] = points; }
+    void setContractValue(uint32_t row, double value) { contractValues[row] = value; }
+    
+    // Column access
+    size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+    const std::vector<int>& getIds() const { return ids; }
+    const std::vector<CustomerKind>& getKinds() const { return kinds; }
+    const std::vector<CustomerHandle>& getHandles() const { return handles; }
+    const std::vector<int>& getRepIds() const { return repIds; }
+    const std::vector<int>& getInteractionTimes() const { return interactionTimes; }
+    const std::vector<double>& getLoyaltyPoints() const { return loyaltyPoints; }
+    const std::vector<double>& getContractValues() const { return contractValues; }
+    const std::vector<uint32_t>& getGroupIds() const { return groupIds; }
+    std::string_view getName(uint32_t row) const { return view(names[row]); }
+    std::string_view getEmail(uint32_t row) const { return view(emails[row]); }
+    
+    // Approximate heap bytes held by the columns, arena and row map
+    size_t getMemoryUsage() const;
+};
@@ -0,0 +1,104 @@
+// Fuzzy duplicate-customer detection
+// duplicate_detector.h
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Fuzzy duplicate-customer detection
+// Each customer is reduced to a MinHash signature over character 3-grams of
+// its normalized name, email and phone. Signatures are split into bands and
+// hashed into buckets (LSH), so only customers that share a bucket, or an
+// identical email / phone, are ever compared. Band buckets above a size cap
+// are skipped, and customers sharing an email or phone with more than that
+// many others (a switchboard number, a role address) are linked as a chain
+// rather than pairwise, so finding pairs stays near-linear. Checking a new
+// customer against such a bucket scores only the first kMaxBucketSize members.
+// Each entry records its position in every bucket it is in, so removal is O(1).
+class DuplicateDetector {
+public:
+    struct Candidate {
+        int firstId;
+        int secondId;
+        double similarity;  // estimated Jaccard similarity of the shingle sets
+        bool exactMatch;    // same normalized email or phone
+    };
+    
+    // Band buckets larger than this carry no blocking signal and are skipped;
+    // exact buckets larger than this are chained or sampled
+    static constexpr size_t kMaxBucketSize = 256;
+
+private:
+    static constexpr int kHashes = 24;
+    static constexpr int kBands = 8;
+    static constexpr int kRows = kHashes / kBands;
+    
+    using Signature = std::array<uint32_t, kHashes>;
+    using ExactKeys = std::unordered_map<std::string, std::vector<uint32_t>>;
+    
+    struct Entry {
+        int customerId;
+        Signature signature;
+        bool active;
+        std::array<ExactKeys::value_type*, 2> exactBuckets;  // email and phone buckets, if any
+        std::array<uint32_t, kBands> bandSlots;               // position in each band bucket
+        std::array<uint32_t, 2> exactSlots;                   // position in each exact bucket
+    };
+    
+    std::vector<Entry> entries;
+    std::unordered_map<int, uint32_t> entryByCustomer;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> bandBuckets;
+    ExactKeys exactKeys;
+    
+    // Take an entry out of a bucket in O(1) by moving the last member into its
+    // place; slotOf returns a member's recorded position in this bucket
+    template <typename SlotOf>
+    static void eraseFromBucket(std::vector<uint32_t>& bucket, uint32_t entry, SlotOf slotOf);
+    
+    static uint64_t mix(uint64_t x);
+    
+    static uint64_t hashString(const std::string& text);
+    
+    static std::string normalizeName(const std::string& name);
+    
+    static std::string normalizeEmail(const std::string& email);
+    
+    static std::string normalizePhone(const std::string& phone);
+    
+    static void addShingles(std::vector<uint64_t>& shingles, char field, const std::string& text);
+    
+    static Signature computeSignature(const std::string& name, const std::string& email, 
+                                      const std::string& phone);
+    
+    static uint64_t bandKey(const Signature& signature, int band);
+    
+    static std::vector<std::string> exactKeysFor(const std::string& email, const std::string& phone);
+    
+    static double similarity(const Signature& a, const Signature& b);
+    
+    // Candidate entries for a signature, mapped to whether they matched an exact key
+    std::unordered_map<uint32_t, bool> probe(const Signature& signature, 
+                                             const std::vector<std::string>& keys) const;
+
+public:
+    // Index a customer so it takes part in duplicate detection
+    void addCustomer(int customerId, const std::string& name, const std::string& email, 
+                     const std::string& phone);
+    
+    // Exclude a customer from further matches, taking it out of every bucket
+    void removeCustomer(int customerId);
+    
+    // Check prospective customer details against everyone already indexed
+    std::vector<Candidate> checkCustomer(const std::string& name, const std::string& email, 
+                                         const std::string& phone, double threshold) const;
+    
+    // All candidate duplicate pairs among the indexed customers
+    std::vector<Candidate> findCandidatePairs(double threshold) const;
+    
+    // Approximate heap bytes held by the signatures and buckets
+    size_t getMemoryUsage() const;
+};
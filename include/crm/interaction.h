@@ -0,0 +1,104 @@
+// Interaction class hierarchy
+// interaction.h
+
+#pragma once
+
+#include <ctime>
+#include <string>
+
+#include "crm/string_pool.h"
+
+// Abstract base class for Interaction (Abstraction)
+class Interaction {
+protected:
+    std::string date;
+    time_t timestamp;
+    std::string content;     // raw text, or TextCodec output when compressed
+    bool compressed = false;
+    std::string type;
+
+public:
+    // Constructor; the timestamp defaults to the current time
+    Interaction(const std::string& content, time_t timestamp);
+    
+    // Virtual destructor for proper inheritance
+    virtual ~Interaction() = default;
+    
+    // Pure virtual method (Abstraction)
+    virtual void display() const = 0;
+    
+    // Text that is made searchable by the interaction index
+    virtual std::string getSearchableText() const { return getContent(); }
+    
+    // Minutes spent on the interaction; zero for interactions without a duration
+    virtual int getDuration() const { return 0; }
+    
+    // Store the content compressed if that saves space; returns bytes saved
+    size_t compressContent();
+    
+    // Getters (Encapsulation)
+    std::string getDate() const { return date; }
+    time_t getTimestamp() const { return timestamp; }
+    bool isCompressed() const { return compressed; }
+    size_t getStoredContentSize() const { return content.capacity(); }
+    
+    // Approximate bytes held by the interaction, including the object itself
+    size_t getMemoryUsage() const;
+    std::string getType() const { return type; }
+    
+    // Content text, decompressed on demand
+    std::string getContent() const;
+};
+
+// Derived class for Call interaction (Inheritance)
+class Call : public Interaction {
+private:
+    int duration; // in minutes
+
+public:
+    Call(const std::string& content, int duration, time_t timestamp = time(nullptr));
+    
+    // Implementation of pure virtual method (Polymorphism)
+    void display() const override;
+    
+    int getDuration() const override { return duration; }
+};
+
+// Derived class for Email interaction (Inheritance)
+class Email : public Interaction {
+private:
+    InternedString subject;
+
+public:
+    Email(const std::string& content, const std::string& subject, time_t timestamp = time(nullptr));
+    
+    // Implementation of pure virtual method (Polymorphism)
+    void display() const override;
+    
+    // Subject is searchable alongside the body
+    std::string getSearchableText() const override { return subject.str() + " " + getContent(); }
+    
+    std::string getSubject() const { return subject; }
+    uint32_t getSubjectId() const { return subject.getId(); }
+};
+
+// Derived class for Meeting interaction (Inheritance)
+class Meeting : public Interaction {
+private:
+    InternedString location;
+    int duration; // in minutes
+
+public:
+    Meeting(const std::string& content, const std::string& location, int duration,
+            time_t timestamp = time(nullptr));
+    
+    // Implementation of pure virtual method (Polymorphism)
+    void display() const override;
+    
+    // Location is searchable alongside the notes
+    std::string getSearchableText() const override { return location.str() + " " + getContent(); }
+    
+    std::string getLocation() const { return location; }
+    uint32_t getLocationId() const { return location.getId(); }
+    int getDuration() const override { return duration; }
+};
@@ -0,0 +1,55 @@
+// On-disk archive for interactions spilled out of memory
+// interaction_archive.h
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "crm/interaction.h"
+
+// Append-only on-disk segment holding interactions spilled out of memory
+// Each record is a 4-byte length followed by the interaction kind, timestamp,
+// duration, content and subject/location. Records are never rewritten, so
+// interactions of removed customers remain in the file as garbage.
+class InteractionArchive {
+private:
+    std::mutex mutex;
+    std::fstream file;
+    std::string path;
+    uint64_t endOffset = 0;
+    
+    static void putU32(std::string& out, uint32_t value);
+    
+    static void putString(std::string& out, const std::string& value);
+    
+    static uint32_t getU32(const std::string& in, size_t& pos);
+    
+    static std::string getString(const std::string& in, size_t& pos);
+
+public:
+    // Open (creating or truncating) the segment file; returns false on failure.
+    // An archive is opened only once, since re-opening would invalidate the
+    // offsets already handed out.
+    bool open(const std::string& segmentPath);
+    
+    bool isOpen() const { return file.is_open(); }
+    uint64_t getSize() const { return endOffset; }
+    
+    // Write an interaction, setting its offset in the segment; false if the
+    // write failed, in which case nothing is recorded
+    bool append(const Interaction& interaction, uint64_t& offset);
+    
+    // Push buffered records to the file; false if they could not be written
+    bool flush();
+    
+    // Forget the records from offset on (e.g. after a failed flush); later
+    // appends overwrite them
+    void truncate(uint64_t offset);
+    
+    // Read an interaction back; returns nullptr if the record cannot be read
+    std::unique_ptr<Interaction> read(uint64_t offset);
+};
@@ -0,0 +1,111 @@
+// Full-text index over interaction content
+// interaction_index.h
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Incremental inverted index over interaction text
+// Posting lists are kept per term as varint-encoded byte streams of
+// (doc delta, term frequency, position deltas) so that phrase queries can be
+// answered without going back to the interaction objects. Each list is cut
+// into blocks of kBlockSize postings, with a skip entry per block holding its
+// last document and byte offset. Queries walk the lists with cursors, rarest
+// term first, and jump over whole blocks of the common terms, so an AND query
+// costs about the size of its rarest list rather than of its longest one.
+// Positions are only decoded for documents a phrase has to be checked in.
+class InteractionIndex {
+public:
+    // A matching interaction: the owning customer and its position in that customer's history
+    struct Hit {
+        int customerId;
+        size_t interactionIndex;
+    };
+    
+    static constexpr uint32_t kBlockSize = 128;  // postings per skip entry
+
+private:
+    struct Skip {
+        uint32_t lastDoc;  // last document in the block
+        uint32_t offset;   // byte offset of the block's first posting
+    };
+    
+    struct PostingList {
+        std::vector<uint8_t> bytes;
+        std::vector<Skip> skips;
+        uint32_t lastDoc = 0;
+        uint32_t docCount = 0;
+    };
+    
+    // Forward iterator over one posting list
+    class Cursor {
+    private:
+        const PostingList* list;
+        size_t pos = 0;           // byte offset of the next posting
+        size_t positionsPos = 0;  // byte offset of the current posting's positions
+        uint32_t ordinal = 0;     // postings read so far
+        uint32_t freq = 0;
+        bool atEnd = false;
+        
+        // Start reading at the first posting of a block
+        void seekBlock(size_t block);
+
+    public:
+        uint32_t doc = 0;
+        
+        // Positioned on the first posting; a null list is empty
+        explicit Cursor(const PostingList* list);
+        
+        bool done() const { return atEnd; }
+        uint32_t size() const { return list ? list->docCount : 0; }
+        
+        bool next();
+        
+        // Move to the first posting at or after target, skipping whole blocks; false at the end
+        bool advanceTo(uint32_t target);
+        
+        // Positions of the term in the current document
+        void positions(std::vector<uint32_t>& out) const;
+    };
+    
+    std::unordered_map<std::string, PostingList> postings;
+    std::vector<Hit> documents;
+    std::unordered_set<int> removedCustomers;  // tombstones, filtered out of results
+    
+    static void writeVarint(std::vector<uint8_t>& out, uint32_t value);
+    
+    static uint32_t readVarint(const std::vector<uint8_t>& in, size_t& pos);
+    
+    static void skipVarints(const std::vector<uint8_t>& in, size_t& pos, uint32_t count);
+    
+    // Documents matching every item of an AND clause; an item of several terms is a phrase
+    std::vector<uint32_t> clauseDocs(const std::vector<std::vector<std::string>>& items) const;
+    
+    static std::vector<uint32_t> unite(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b);
+
+public:
+    // Split text into lower-case alphanumeric terms
+    static std::vector<std::string> tokenize(const std::string& text);
+    
+    // Index an interaction; documents must be added in arrival order
+    void addInteraction(int customerId, size_t interactionIndex, const std::string& text);
+    
+    // Search the index. Terms are ANDed, "quoted text" matches a phrase and
+    // OR separates alternatives, e.g.: renewal "quarterly review" OR upgrade
+    std::vector<Hit> search(const std::string& query) const;
+    
+    // Stop returning a customer's interactions; postings are left in place
+    void removeCustomer(int customerId) {
+        removedCustomers.insert(customerId);
+    }
+    
+    size_t getDocumentCount() const { return documents.size(); }
+    size_t getTermCount() const { return postings.size(); }
+    
+    // Approximate heap bytes held by the posting lists and document table
+    size_t getMemoryUsage() const;
+};
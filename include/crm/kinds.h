@@ -0,0 +1,21 @@
+// Customer and interaction kinds
+// kinds.h
+
+#pragma once
+
+#include <cstdint>
+
+// Concrete customer kinds, in the same order as the CustomerVariant alternatives
+enum class CustomerKind : uint8_t { Regular, VIP, Corporate };
+
+inline const char* customerKindName(CustomerKind kind) {
+    switch (kind) {
+        case CustomerKind::Regular: return "Regular";
+        case CustomerKind::VIP: return "VIP";
+        case CustomerKind::Corporate: return "Corporate";
+    }
+    return "Unknown";
+}
+
+// Concrete interaction kinds
+enum class InteractionKind : uint8_t { Call, Email, Meeting };
@@ -0,0 +1,127 @@
+// Logger used for side-effect messages of CRM operations
+// logger.h
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+// Severity of a log message; Off disables logging entirely
+enum class LogLevel : uint8_t { Debug, Info, Warning, Off };
+
+// Logger for side-effect messages printed by the record* operations
+// By default messages are written straight to the output stream. After
+// startAsync() they are pushed into a lock-free bounded ring buffer (one
+// sequence counter per slot, so producers never take a lock) and written by
+// a background thread; messages are dropped and counted if the ring is full.
+// Messages longer than a slot skip the ring and are written directly, after
+// whatever is already queued. Call flush() before printing to the same stream
+// directly to keep output ordered.
+class Logger {
+private:
+    static constexpr size_t kCapacity = 8192;        // power of two
+    static constexpr size_t kMaxMessage = 240;       // longer messages are written directly
+    
+    struct Slot {
+        std::atomic<size_t> sequence;
+        uint16_t length;
+        char text[kMaxMessage];
+    };
+    
+    std::unique_ptr<Slot[]> ring;
+    std::atomic<size_t> enqueuePos{0};
+    std::atomic<size_t> dequeuePos{0};
+    std::atomic<uint8_t> level{static_cast<uint8_t>(LogLevel::Info)};
+    std::atomic<bool> asyncMode{false};
+    std::atomic<bool> running{false};
+    std::atomic<int> inFlight{0};  // producers between checking asyncMode and finishing their push
+    std::atomic<uint64_t> dropped{0};
+    std::ostream* out = &std::cout;
+    std::mutex writeMutex;
+    std::thread worker;
+    
+    // Queue a message that fits in a slot; false if the ring is full
+    bool tryPush(const std::string& message);
+    
+    // Write out every queued message; callers hold writeMutex, so only one thread pops at a time
+    size_t drainLocked();
+    
+    size_t drain();
+    
+    void run();
+
+public:
+    Logger();
+    
+    ~Logger() { stopAsync(); }
+    
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+    
+    // The logger used by the CRM classes
+    static Logger& instance();
+    
+    void setLevel(LogLevel newLevel) { level.store(static_cast<uint8_t>(newLevel)); }
+    LogLevel getLevel() const { return static_cast<LogLevel>(level.load()); }
+    
+    bool isEnabled(LogLevel messageLevel) const {
+        return static_cast<uint8_t>(messageLevel) >= level.load(std::memory_order_relaxed);
+    }
+    
+    // Redirect output; only call while no messages are queued
+    void setOutput(std::ostream& stream);
+    
+    // Start the background writer thread
+    void startAsync();
+    
+    // Write out queued messages and return to synchronous logging; messages
+    // logged concurrently are either queued before the final drain or written directly
+    void stopAsync();
+    
+    // Wait until every message queued so far has been written
+    void flush();
+    
+    void log(LogLevel messageLevel, const std::string& message);
+    
+    uint64_t getDroppedCount() const { return dropped.load(); }
+};
+
+// Per-thread stream CRM_LOG formats into
+// The stream and its buffer are reused from message to message, so once a
+// thread's buffer has grown to fit its messages logging allocates nothing.
+class LogBuffer : private std::streambuf, public std::ostream {
+private:
+    std::string text;
+    
+    std::streambuf::int_type overflow(std::streambuf::int_type ch) override;
+    
+    std::streamsize xsputn(const char* data, std::streamsize count) override;
+    
+    LogBuffer();
+
+public:
+    // The calling thread's buffer
+    static LogBuffer& local();
+    
+    // Clear the text and reset formatting flags left by the previous message
+    std::ostream& start();
+    
+    const std::string& str() const { return text; }
+};
+
+// Log a streamed message, e.g. CRM_LOG(LogLevel::Info, "Call recorded with " << name);
+// the message is only formatted when the level is enabled
+#define CRM_LOG(level, message)                                      \
+    do {                                                             \
+        if (Logger::instance().isEnabled(level)) {                   \
+            LogBuffer& crmLogBuffer = LogBuffer::local();            \
+            crmLogBuffer.start() << message;                         \
+            Logger::instance().log(level, crmLogBuffer.str());       \
+        }                                                            \
+    } while (0)
@@ -0,0 +1,69 @@
+// Batched ledger of VIP loyalty accruals
+// loyalty_ledger.h
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// Why loyalty points were granted
+enum class LoyaltyReason : uint8_t { Call, Email, Meeting, Manual };
+
+// Append-only ledger of loyalty point accruals
+// Amounts are fixed-point (thousandths of a point). Accruals are buffered
+// and committed in batches: a commit appends the batch to the ledger, folds
+// it into the running balances and reports the per-customer deltas, so
+// recording an interaction only costs a vector append.
+class LoyaltyLedger {
+public:
+    static constexpr int64_t kScale = 1000;
+    
+    struct Entry {
+        int customerId;
+        LoyaltyReason reason;
+        int64_t amount;  // thousandths of a point
+        time_t timestamp;
+    };
+    
+    // Called on commit with each customer's total change in points
+    using CommitCallback = std::function<void(int customerId, double points)>;
+
+private:
+    std::vector<Entry> entries;
+    std::vector<Entry> pending;
+    std::unordered_map<int, int64_t> balances;
+    size_t batchSize;
+    CommitCallback onCommit;
+
+public:
+    explicit LoyaltyLedger(size_t batchSize = 1024) : batchSize(batchSize) {}
+    
+    void setCommitCallback(CommitCallback callback) { onCommit = std::move(callback); }
+    void setBatchSize(size_t size) { batchSize = std::max<size_t>(size, 1); }
+    
+    static int64_t toFixed(double points) { return static_cast<int64_t>(std::llround(points * kScale)); }
+    static double fromFixed(int64_t amount) { return static_cast<double>(amount) / kScale; }
+    
+    // Queue an accrual; the batch is committed once it is full
+    void accrue(int customerId, double points, LoyaltyReason reason, time_t timestamp = time(nullptr));
+    
+    // Append pending accruals to the ledger and materialize balances
+    void commit();
+    
+    // Committed balance in points
+    double getBalance(int customerId) const;
+    
+    // Committed entries for one customer, oldest first (scans the ledger)
+    std::vector<Entry> getHistory(int customerId) const;
+    
+    size_t getEntryCount() const { return entries.size(); }
+    
+    // Approximate heap bytes held by the ledger and balances
+    size_t getMemoryUsage() const;
+    size_t getPendingCount() const { return pending.size(); }
+};
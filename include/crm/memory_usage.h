@@ -0,0 +1,26 @@
+// Approximate heap usage of standard containers, for memory reporting
+// memory_usage.h
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+template <typename T>
+size_t vectorMemory(const std::vector<T>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+// Bucket array plus one node per element (value, next pointer and cached hash)
+template <typename Table>
+size_t hashTableMemory(const Table& table) {
+    return table.bucket_count() * sizeof(void*) + 
+           table.size() * (sizeof(typename Table::value_type) + 2 * sizeof(void*));
+}
+
+// Heap bytes of a string; short strings live inside the object
+inline size_t stringMemory(const std::string& text) {
+    static const size_t inlineCapacity = std::string().capacity();
+    return text.capacity() > inlineCapacity ? text.capacity() + 1 : 0;
+}
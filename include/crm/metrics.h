@@ -0,0 +1,239 @@
+// Per-operation latency histograms for the public CRM API
+// metrics.h
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CRM_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CRM_HAS_TSC 1
+#endif
+
+// Instrumented public operations of CRM and SalesRepresentative
+// Every public operation is timed except constructors, the Customer observer
+// callbacks, configuration setters (CRM::setCustomerIdSpace, setHistoryClock,
+// SalesRepresentative::setLoyaltyLedger, setScoringRules), field accessors
+// that return a member (SalesRepresentative::getId, getName, getCustomers,
+// getCustomerCount) and SalesRepresentative::getMemoryUsage, which is timed
+// as part of CRM::getMemoryUsage.
+enum class Operation : uint8_t {
+    CreateRegularCustomer,
+    CreateVIPCustomer,
+    CreateCorporateCustomer,
+    CreateSalesRepresentative,
+    GetCustomer,
+    GetSalesRepresentative,
+    GetCustomerAsOf,
+    GetCustomers,
+    GetSalesRepresentatives,
+    AssignCustomerToRep,
+    AutoAssignCustomer,
+    DecayRepWorkloads,
+    RebalanceCustomers,
+    RemoveSalesRepresentative,
+    ReassignCustomer,
+    ReassignCustomers,
+    UnassignCustomer,
+    RemoveCustomer,
+    DisplayAllCustomers,
+    DisplayAllSalesReps,
+    FilterCustomers,
+    GetTotalLoyaltyPoints,
+    CompressInteractions,
+    LoadScoringRules,
+    AddLoyaltyPoints,
+    CommitLoyaltyPoints,
+    GetLoyaltyBalance,
+    GetLoyaltyHistory,
+    RenewContracts,
+    GetAnnualContractValue,
+    GenerateRevenueReport,
+    ScheduleCampaign,
+    EnableInteractionTiering,
+    SpillInteractions,
+    CountCustomersBySegment,
+    CountCustomersByAccountManager,
+    CountMeetingsByLocation,
+    SearchInteractions,
+    DisplaySearchResults,
+    GetTopCustomers,
+    DisplayTopCustomers,
+    FindDuplicateCustomers,
+    FindPossibleDuplicates,
+    GenerateSystemReport,
+    CountCustomersByType,
+    GetMemoryUsage,
+    GetReportSummary,
+    OpenReportSnapshot,
+    GenerateInteractionTimeReports,
+    RecordInteractions,
+    RepAddCustomer,
+    RepRemoveCustomer,
+    RecordCall,
+    RecordEmail,
+    RecordMeeting,
+    RepRecordInteractions,
+    PerformCustomerActions,
+    ScheduleCustomerActions,
+    DisplayCustomers,
+    ViewCustomerInteractions,
+    GenerateInteractionTimeReport,
+    Count
+};
+
+// Qualified method name of an operation, e.g. "SalesRepresentative::recordCall"
+const char* operationName(Operation operation);
+
+// Log-linear latency histogram in the style of HdrHistogram
+// Values below 2 * kSubBuckets get a bucket each; above that every power of
+// two is split into kSubBuckets equal buckets, so any recorded value is
+// known to within 1 / kSubBuckets (about 6%). Counters are relaxed atomics,
+// so recording is a couple of uncontended increments and safe from any thread.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr uint64_t kSubBuckets = 1u << kSubBucketBits;
+    static constexpr int kMaxExponent = 42;  // larger values are clamped
+    static constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits) * kSubBuckets + 2 * kSubBuckets;
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> maximum{0};
+
+public:
+    static size_t bucketFor(uint64_t value) {
+        if (value < 2 * kSubBuckets)
+            return static_cast<size_t>(value);
+#if defined(_MSC_VER)
+        unsigned long highBit;
+        _BitScanReverse64(&highBit, value);
+        int exponent = static_cast<int>(highBit);
+#else
+        int exponent = 63 - __builtin_clzll(value);
+#endif
+        if (exponent > kMaxExponent)
+            return kBucketCount - 1;
+        int shift = exponent - kSubBucketBits;
+        return static_cast<size_t>(shift) * kSubBuckets + static_cast<size_t>(value >> shift);
+    }
+    
+    // Smallest value that falls into a bucket
+    static uint64_t bucketLowerBound(size_t bucket) {
+        if (bucket < kSubBuckets)
+            return bucket;
+        int shift = static_cast<int>(bucket >> kSubBucketBits) - 1;
+        return ((bucket & (kSubBuckets - 1)) + kSubBuckets) << shift;
+    }
+    
+    void record(uint64_t value) {
+        buckets[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(value, std::memory_order_relaxed);
+        uint64_t current = maximum.load(std::memory_order_relaxed);
+        while (value > current &&
+               !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+    
+    uint64_t getCount() const;
+    uint64_t getTotal() const { return total.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return maximum.load(std::memory_order_relaxed); }
+    
+    // Upper edge of the bucket holding the given quantile (0..1), capped at the maximum
+    uint64_t getPercentile(double quantile) const;
+    
+    void reset();
+};
+
+// Process-wide latency histograms, one per Operation
+// Latencies are recorded in raw clock ticks (the TSC on x86, nanoseconds
+// elsewhere) and only converted to nanoseconds when exported, so timing an
+// operation costs two clock reads and a histogram update.
+class Metrics {
+public:
+    // Latency summary of one operation, in nanoseconds
+    struct OperationStats {
+        uint64_t count;
+        double mean;
+        double p50;
+        double p90;
+        double p99;
+        double p999;
+        double max;
+    };
+
+private:
+    std::array<LatencyHistogram, static_cast<size_t>(Operation::Count)> histograms;
+    std::atomic<bool> enabled{true};
+    
+    // Reference points for converting ticks to nanoseconds
+    uint64_t startTicks;
+    std::chrono::steady_clock::time_point startTime;
+    
+    double nanosPerTick() const;
+
+public:
+    Metrics();
+    
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+    
+    // The metrics recorded by the CRM classes
+    static Metrics& instance() {
+        static Metrics metrics;
+        return metrics;
+    }
+    
+    static uint64_t now() {
+#if defined(CRM_HAS_TSC)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+    
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+    
+    void record(Operation operation, uint64_t ticks) {
+        histograms[static_cast<size_t>(operation)].record(ticks);
+    }
+    
+    OperationStats getStats(Operation operation) const;
+    
+    // One line per operation that has been called
+    std::string toText() const;
+    
+    // {"operations": [{"name": ..., "count": ..., "mean_ns": ..., ...}, ...]}
+    std::string toJson() const;
+    
+    void reset();
+};
+
+// Records the latency of the enclosing scope, e.g. OperationTimer timer(Operation::RecordCall);
+class OperationTimer {
+private:
+    Operation operation;
+    uint64_t start;
+
+public:
+    explicit OperationTimer(Operation operation)
+        : operation(operation), start(Metrics::instance().isEnabled() ? Metrics::now() : 0) {}
+    
+    ~OperationTimer() {
+        if (start)
+            Metrics::instance().record(operation, Metrics::now() - start);
+    }
+    
+    OperationTimer(const OperationTimer&) = delete;
+    OperationTimer& operator=(const OperationTimer&) = delete;
+};
@@ -0,0 +1,70 @@
+// Sales rep workload tracking for customer assignment
+// rep_load_balancer.h
+
+#pragma once
+
+#include <cstddef>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+// Tracks the workload of each sales rep so new customers go to the least loaded one
+// Load is the number of customers plus recent interaction minutes, where
+// minutesPerCustomer recent minutes weigh as much as one extra customer.
+// Reps are also ordered by portfolio size alone for rebalancing, since
+// recent minutes stay with the rep rather than moving with its customers.
+class RepLoadBalancer {
+private:
+    struct Load {
+        size_t customers = 0;
+        double recentMinutes = 0;
+    };
+    
+    double minutesPerCustomer;
+    std::unordered_map<int, Load> loads;
+    std::set<std::pair<double, int>> byLoad;  // (load, rep id), least loaded first
+    std::set<std::pair<size_t, int>> byCustomers;  // (customers, rep id), smallest portfolio first
+    
+    double score(const Load& load) const {
+        return static_cast<double>(load.customers) + load.recentMinutes / minutesPerCustomer;
+    }
+    
+    // Apply a change to a rep's load, keeping the ordering up to date
+    template <typename Update>
+    void update(int repId, Update change) {
+        auto it = loads.find(repId);
+        if (it == loads.end())
+            return;
+        byLoad.erase({score(it->second), repId});
+        byCustomers.erase({it->second.customers, repId});
+        change(it->second);
+        byLoad.insert({score(it->second), repId});
+        byCustomers.insert({it->second.customers, repId});
+    }
+
+public:
+    explicit RepLoadBalancer(double minutesPerCustomer = 60.0)
+        : minutesPerCustomer(minutesPerCustomer) {}
+    
+    void addRep(int repId);
+    
+    void removeRep(int repId);
+    
+    void customerAdded(int repId) { update(repId, [](Load& load) { load.customers++; }); }
+    void customerRemoved(int repId) { update(repId, [](Load& load) { load.customers--; }); }
+    
+    void recordMinutes(int repId, int minutes) {
+        update(repId, [minutes](Load& load) { load.recentMinutes += minutes; });
+    }
+    
+    // Age recent minutes, e.g. decayRecentMinutes(0.5) once a week
+    void decayRecentMinutes(double factor);
+    
+    bool empty() const { return loads.empty(); }
+    int leastLoadedRep() const { return byLoad.empty() ? 0 : byLoad.begin()->second; }
+    int mostLoadedRep() const { return byLoad.empty() ? 0 : byLoad.rbegin()->second; }
+    int smallestPortfolioRep() const { return byCustomers.empty() ? 0 : byCustomers.begin()->second; }
+    int largestPortfolioRep() const { return byCustomers.empty() ? 0 : byCustomers.rbegin()->second; }
+    
+    double getLoad(int repId) const;
+};
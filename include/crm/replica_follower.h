@@ -0,0 +1,68 @@
+// Read replica that follows a primary CrmServer
+// replica_follower.h
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "crm/crm_service.h"
+
+class CRM;
+
+// Keeps a CRM in sync with a primary CrmServer that has a replication log
+// A background thread subscribes to the primary, loads the snapshot into the
+// (empty) CRM and then applies every mutation the primary logs, each batch
+// of received frames under one acquisition of crmMutex. If the connection
+// drops it reconnects and resumes from the next sequence number; if the
+// primary no longer retains that part of its log, or the connection dropped
+// before the snapshot was complete, the replica cannot catch up and stops.
+// Serve the replica's CRM with a read-only CrmServer.
+class ReplicaFollower {
+private:
+    static constexpr int kPollMillis = 100;    // how quickly stop() is noticed
+    static constexpr int kRetryMillis = 1000;  // delay between reconnection attempts
+    
+    std::mutex& crmMutex;
+    CrmService service;
+    std::string host;
+    uint16_t port = 0;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> nextSequence{0};
+    std::thread worker;
+    
+    // Reused across reads
+    ServiceRequest batch;
+    ServiceResponse batchResponse;
+    
+    void run();
+    
+    // Subscribe over a new connection and apply what arrives until the
+    // connection fails or stop() is called; false if following cannot continue
+    bool follow(int fd);
+    
+    // Apply the requests in batch; false if any of them failed
+    bool applyBatch();
+
+public:
+    ReplicaFollower(CRM& crm, std::mutex& crmMutex) : crmMutex(crmMutex), service(crm) {}
+    
+    ~ReplicaFollower() { stop(); }
+    
+    ReplicaFollower(const ReplicaFollower&) = delete;
+    ReplicaFollower& operator=(const ReplicaFollower&) = delete;
+    
+    // Start following the primary at an IPv4 address
+    bool start(const std::string& primaryHost, uint16_t primaryPort);
+    
+    void stop();
+    
+    // False once stopped, including when following had to give up
+    bool isRunning() const { return running.load(); }
+    
+    // Sequence number of the next log entry to apply; 0 until the snapshot is loaded
+    uint64_t getNextSequence() const { return nextSequence.load(); }
+};
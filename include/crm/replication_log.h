@@ -0,0 +1,50 @@
+// Mutation log shipped from a primary CRM to its read replicas
+// replication_log.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include "crm/service_protocol.h"
+
+// Bounded in-memory log of mutating service requests
+// Every successful mutation is appended as an encoded request frame and gets
+// the next sequence number (starting at 1). Replaying the frames in order
+// on a CRM that started from the same state reproduces the primary, since ids
+// are handed out in creation order. Once the retained bytes pass the capacity
+// the oldest half is dropped; a follower that needs dropped entries must
+// start again from a snapshot.
+class ReplicationLog {
+private:
+    size_t capacity;
+    std::string frames;
+    std::deque<size_t> offsets;   // start of each retained frame in frames
+    uint64_t firstSequence = 1;   // sequence number of the first retained frame
+    
+    // Drop the oldest frames until at most half the capacity is retained
+    void trim();
+
+public:
+    static constexpr size_t kDefaultCapacity = 64 * 1024 * 1024;
+    
+    explicit ReplicationLog(size_t capacity = kDefaultCapacity) : capacity(capacity) {}
+    
+    void append(const ServiceRequest& request);
+    
+    uint64_t getFirstSequence() const { return firstSequence; }
+    uint64_t getNextSequence() const { return firstSequence + offsets.size(); }
+    size_t getSize() const { return frames.size(); }
+    
+    // True if a follower whose next sequence is `sequence` can be served from the log
+    bool canResumeFrom(uint64_t sequence) const {
+        return sequence >= firstSequence && sequence <= getNextSequence();
+    }
+    
+    // Append the frames from `sequence` to the end of the log, at most maxBytes
+    // of them (always at least one), returning the sequence after the last one
+    // copied. `sequence` must satisfy canResumeFrom.
+    uint64_t copyFrom(uint64_t sequence, std::string& out, size_t maxBytes = SIZE_MAX) const;
+};
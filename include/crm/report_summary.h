@@ -0,0 +1,45 @@
+// Mergeable aggregates behind the system-wide reports
+// report_summary.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "crm/kinds.h"
+
+// The figures the system, revenue, rep and top-customer reports print,
+// collected so that summaries of disjoint customer sets (e.g. the shards of
+// a partitioned deployment) can be added up and printed as one report.
+// Every summary of a deployment lists the same reps in the same order.
+struct ReportSummary {
+    struct CustomerTotals {
+        int id = 0;
+        std::string name;
+        CustomerKind kind = CustomerKind::Regular;
+        int minutes = 0;  // total interaction time, multipliers applied
+    };
+    
+    struct RepTotals {
+        std::string name;
+        int64_t contractCents = 0;
+        std::vector<CustomerTotals> customers;  // only filled in for the rep report
+    };
+    
+    uint32_t customersByKind[3] = {0, 0, 0};
+    int64_t interactionMinutes = 0;
+    int64_t contractCents = 0;
+    std::vector<RepTotals> reps;
+    std::vector<CustomerTotals> top;  // most interaction time first, ties by lowest id
+    
+    // Add another summary's figures to this one, keeping the topK best customers
+    void merge(const ReportSummary& other, size_t topK);
+    
+    void writeSystemReport(std::ostream& out) const;
+    void writeRevenueReport(std::ostream& out) const;
+    void writeInteractionTimeReports(std::ostream& out) const;
+    void writeTopCustomers(size_t k, std::ostream& out) const;
+};
@@ -0,0 +1,135 @@
+// Multi-version copy of the report fields for lock-free report snapshots
+// report_versions.h
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "crm/kinds.h"
+#include "crm/report_summary.h"
+
+// Versioned mirror of the customer table columns the reports read
+// Rows live in fixed-size chunks and follow the customer table's row order
+// (including its swap-removes). A snapshot pins the current epoch and copies
+// the chunk pointers; after that the writer never changes a chunk an open
+// snapshot can see, but replaces it with a copy stamped with a newer epoch.
+// A replaced chunk is retired and freed as soon as no open snapshot's epoch
+// falls between its own and the one it was replaced in, so memory held for
+// old versions is bounded by what open snapshots actually use.
+//
+// Writes and opening snapshots must be serialized by the caller (they run
+// under the CRM's lock); a snapshot can then be read and released on any
+// thread without that lock, concurrently with further writes.
+class ReportVersions {
+public:
+    struct Row {
+        int id;
+        int repId;
+        uint32_t repSlot;        // position in the rep's portfolio, if assigned
+        int minutes;             // total interaction time, multipliers applied
+        CustomerKind kind;
+        int64_t contractCents;   // Corporate only, 0 otherwise
+        std::string name;
+    };
+
+private:
+    static constexpr size_t kChunkRows = 256;
+    
+    struct Chunk {
+        uint64_t epoch;          // epoch the chunk was created in
+        std::vector<Row> rows;
+    };
+    
+    struct Retired {
+        uint64_t replacedIn;     // epoch in which the chunk was replaced
+        std::unique_ptr<Chunk> chunk;
+    };
+    
+    std::vector<std::unique_ptr<Chunk>> chunks;  // only the last one may be partly filled
+    size_t rowCount = 0;
+    std::vector<std::pair<int, std::string>> reps;  // (id, name) in creation order
+    
+    // Epoch bookkeeping, shared with snapshots released on other threads
+    mutable std::mutex epochMutex;
+    uint64_t currentEpoch = 1;
+    std::multiset<uint64_t> pinned;           // epochs of open snapshots
+    std::atomic<uint64_t> newestPinned{0};    // largest pinned epoch, 0 if none
+    std::vector<Retired> retired;
+    
+    // The chunk holding a row, copied first if an open snapshot may see it
+    Chunk& writableChunk(size_t index);
+    
+    Row& writableRow(uint32_t row) { return writableChunk(row / kChunkRows).rows[row % kChunkRows]; }
+    
+    void release(uint64_t epoch);
+    
+    // Free the retired chunks no open snapshot can see; epochMutex must be held
+    void reclaim();
+
+public:
+    // Consistent view of the rows and reps as of one epoch
+    class Snapshot {
+    private:
+        friend class ReportVersions;
+        
+        ReportVersions* versions = nullptr;
+        uint64_t epoch = 0;
+        std::vector<const Chunk*> chunks;
+        std::vector<std::pair<int, std::string>> reps;
+        size_t rowCount = 0;
+
+    public:
+        Snapshot() = default;
+        ~Snapshot() { release(); }
+        
+        Snapshot(Snapshot&& other) noexcept { *this = std::move(other); }
+        Snapshot& operator=(Snapshot&& other) noexcept;
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        
+        // Unpin the epoch; the snapshot is empty afterwards
+        void release();
+        
+        uint64_t getEpoch() const { return epoch; }
+        size_t getCustomerCount() const { return rowCount; }
+        
+        // Figures for the reports as of this snapshot (see CRM::getReportSummary).
+        // Each rep's customers are listed in portfolio order.
+        ReportSummary summarize(size_t topK, bool withRepCustomers) const;
+    };
+    
+    ReportVersions() = default;
+    
+    ReportVersions(const ReportVersions&) = delete;
+    ReportVersions& operator=(const ReportVersions&) = delete;
+    
+    // Row updates, mirroring CustomerTable
+    void add(Row row);
+    void remove(uint32_t row);
+    void setRepId(uint32_t row, int repId, uint32_t repSlot);
+    void setRepSlot(uint32_t row, uint32_t repSlot) { writableRow(row).repSlot = repSlot; }
+    uint32_t getRepSlot(uint32_t row) const { return chunks[row / kChunkRows]->rows[row % kChunkRows].repSlot; }
+    void setMinutes(uint32_t row, int minutes);
+    void setContractCents(uint32_t row, int64_t cents);
+    
+    void addRep(int repId, const std::string& name) { reps.emplace_back(repId, name); }
+    void removeRep(int repId);
+    
+    // Pin the current version. Every snapshot must be released before the
+    // ReportVersions is destroyed.
+    Snapshot openSnapshot();
+    
+    size_t getOpenSnapshotCount() const;
+    size_t getRetiredChunkCount() const;
+    
+    // Approximate heap bytes held by current and retired chunks
+    size_t getMemoryUsage() const;
+};
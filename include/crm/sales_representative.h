@@ -0,0 +1,107 @@
+// SalesRepresentative class
+// sales_representative.h
+
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "crm/campaign_scheduler.h"
+#include "crm/customer_store.h"
+#include "crm/kinds.h"
+#include "crm/loyalty_ledger.h"
+#include "crm/scoring_rules.h"
+
+// One interaction to record as part of a batch
+struct InteractionRecord {
+    int repId;
+    int customerId;
+    InteractionKind kind;
+    int duration;         // calls and meetings
+    std::string content;
+    std::string detail;   // email subject or meeting location
+};
+
+// SalesRepresentative class
+class SalesRepresentative {
+private:
+    int id;
+    std::string name;
+    CustomerRegistry* registry;
+    LoyaltyLedger* ledger = nullptr;
+    const ScoringRules* rules = &ScoringRules::defaults();
+    std::vector<CustomerHandle> customers;
+    std::unordered_map<int, size_t> positions;  // customer id -> index in customers
+    
+    // Private method for finding a customer (Encapsulation)
+    Customer* findCustomer(int customerId);
+    
+    // Grant VIP loyalty points, through the ledger when one is attached
+    void accrueLoyalty(Customer* customer, double points, LoyaltyReason reason);
+    
+    // Add an interaction to a customer in the portfolio and accrue its loyalty points
+    bool addInteraction(int customerId, std::unique_ptr<Interaction> interaction, InteractionKind kind);
+
+public:
+    SalesRepresentative(int id, const std::string& name, CustomerRegistry* registry)
+        : id(id), name(name), registry(registry) {}
+    
+    // Record loyalty accruals in a ledger instead of updating customers directly
+    void setLoyaltyLedger(LoyaltyLedger* newLedger) { ledger = newLedger; }
+    
+    // Score interactions with the given rules instead of the defaults
+    void setScoringRules(const ScoringRules* newRules) { rules = newRules; }
+    
+    // Add a customer to the rep's portfolio
+    void addCustomer(CustomerHandle handle);
+    
+    // Remove a customer from the rep's portfolio in O(1), returning its handle (null if not assigned)
+    // The last customer takes the removed one's place, so portfolio order is not preserved.
+    CustomerHandle removeCustomer(int customerId);
+    
+    // Record a call with a customer; false if the customer is not in the portfolio
+    bool recordCall(int customerId, const std::string& content, int duration);
+    
+    // Record an email to a customer; false if the customer is not in the portfolio
+    bool recordEmail(int customerId, const std::string& content, const std::string& subject);
+    
+    // Record a meeting with a customer; false if the customer is not in the portfolio
+    bool recordMeeting(int customerId, const std::string& content, 
+                       const std::string& location, int duration);
+    
+    // Record records[begin, end), all of which belong to this rep, in one pass,
+    // setting recorded[i] for each. Returns the number recorded.
+    size_t recordInteractions(const std::vector<InteractionRecord>& records, size_t begin, size_t end, 
+                              std::vector<bool>& recorded);
+    
+    // Perform customer-specific actions for all customers
+    void performCustomerActions();
+    
+    // Queue customer-specific actions on a scheduler instead of running them inline.
+    // VIP customers go first, then corporate, then regular. Each job carries its
+    // action as prepared when it was queued and never touches the customer, so
+    // the CRM can change freely while jobs run. Jobs write to out one action at
+    // a time; it must outlive them.
+    void scheduleCustomerActions(CampaignScheduler& scheduler, std::ostream& out = std::cout) const;
+    
+    // Display customers
+    void displayCustomers() const;
+    
+    // View customer interactions
+    void viewCustomerInteractions(int customerId);
+    
+    // Generate a report of total interaction times
+    void generateInteractionTimeReport(std::ostream& out = std::cout) const;
+    
+    // Getters
+    int getId() const { return id; }
+    std::string getName() const { return name; }
+    const std::vector<CustomerHandle>& getCustomers() const { return customers; }
+    size_t getCustomerCount() const { return customers.size(); }
+    
+    // Approximate heap bytes held by the portfolio
+    size_t getMemoryUsage() const;
+};
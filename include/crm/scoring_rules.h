@@ -0,0 +1,56 @@
+// Configurable loyalty and interaction-time scoring rules
+// scoring_rules.h
+
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "crm/kinds.h"
+
+// Scoring rules for loyalty accrual and interaction-time multipliers
+// Rules are read from a "key = value" config file and compiled into flat
+// tables: loyalty points for an interaction are flat[kind] +
+// perMinute[kind] * duration, and each customer's multiplier is resolved
+// once (when created or when rules are reloaded) and stored on the customer.
+// Each CRM holds its own rules, so loading rules into one leaves others as
+// they were.
+//
+//   call.points_per_minute = 0.5
+//   email.points = 10
+//   vip.multiplier = 1.2
+//   corporate.tier = 1000 1.5    # more than 1000 employees
+class ScoringRules {
+private:
+    struct CorporateTier {
+        int minEmployees;  // tier applies above this many employees
+        double multiplier;
+    };
+    
+    double flatPoints[3] = {0, 10, 0};
+    double pointsPerMinute[3] = {0.5, 0, 2};
+    double kindMultipliers[3] = {1.0, 1.2, 1.0};
+    std::vector<CorporateTier> corporateTiers = {{100, 1.3}, {1000, 1.5}};
+    
+    static bool interactionIndex(const std::string& name, int& index);
+    
+    static bool customerIndex(const std::string& name, int& index);
+
+public:
+    // The built-in rules, used until a CRM loads its own
+    static const ScoringRules& defaults();
+    
+    // Loyalty points earned by an interaction
+    double loyaltyPoints(InteractionKind kind, int duration) const;
+    
+    // Interaction-time multiplier for a customer; employees only matters for corporate customers
+    double multiplierFor(CustomerKind kind, int employees = 0) const;
+    
+    // Parse rules from a stream, starting from the defaults for unspecified keys.
+    // Returns false and sets error on the first malformed line, including a line
+    // with anything after its values.
+    bool parse(std::istream& in, std::string& error);
+    
+    bool loadFromFile(const std::string& path, std::string& error);
+};
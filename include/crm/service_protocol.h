@@ -0,0 +1,136 @@
+// Binary request/response protocol of the CRM network service
+// service_protocol.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "crm/kinds.h"
+#include "crm/report_summary.h"
+
+// Every frame is a 4-byte little-endian payload length followed by the payload.
+// Requests start with the opcode and a client-chosen request id; responses
+// echo both and add a status. Integers are little-endian, doubles are their
+// IEEE-754 bits and strings are a 4-byte length followed by the bytes.
+// Responses come back in request order, so clients may pipeline freely.
+//
+//   request   [u8 op][u32 id][body]
+//   response  [u8 op][u32 id][u8 status][body, only when status is Ok]
+//
+//   op              request body                                   response body
+//   CreateCustomer  u8 kind, name, email, phone, group,            u32 customer id
+//                   u32 employees, f64 annual contract
+//   CreateRep       name                                           u32 rep id
+//   Assign          u32 customer id, u32 rep id                    -
+//   RecordCall      u32 rep id, u32 customer id, content, u32 minutes
+//   RecordEmail     u32 rep id, u32 customer id, content, subject
+//   RecordMeeting   u32 rep id, u32 customer id, content, location, u32 minutes
+//   GetCustomer     u32 customer id                                u8 kind, u32 rep id, u32 minutes,
+//                                                                  name, email, phone
+//   Report          u8 report, u32 count (top-k only)              text
+//   Batch           u32 n, then n request frames                   u32 n, then n response frames
+//   Subscribe       u64 next sequence (0 for a snapshot)           u32 snapshot frames, u64 sequence
+//   Summary         u8 report, u32 count (top-k only)              summary
+//
+// The customer group is the segment, account manager or company name. A batch
+// carries many requests in one frame and gets all their responses back in one
+// frame, in order; its own status is BadRequest only if it cannot be decoded.
+// Batches cannot be nested.
+//
+// Subscribe turns the connection into a replication stream (see
+// ReplicationLog): after the response the server sends the given number of
+// snapshot request frames, then every logged mutation as a request frame,
+// starting at the returned sequence number. Read replicas answer mutating
+// requests with ReadOnly. A u64 is sent as two u32s, low half first.
+//
+// Summary returns the figures behind a report (see ReportSummary) instead of
+// its text, so that a router can add up the summaries of several shards. The
+// reps carry their customers only for the Reps report:
+//
+//   summary   u32 customers per kind x3, u64 interaction minutes, u64 contract cents,
+//             u32 n, then n reps:      name, u64 contract cents, u32 m, then m customers
+//             u32 n, then n customers: u32 id, name, u8 kind, u32 minutes
+//
+// A router answers Unavailable when it cannot reach the shard that holds
+// a request's customer.
+
+static constexpr uint32_t kMaxServiceFrame = 16 * 1024 * 1024;
+
+enum class ServiceOp : uint8_t {
+    CreateCustomer = 1,
+    CreateRep,
+    Assign,
+    RecordCall,
+    RecordEmail,
+    RecordMeeting,
+    GetCustomer,
+    Report,
+    Batch,
+    Subscribe,
+    Summary
+};
+
+enum class ServiceStatus : uint8_t { Ok, NotFound, BadRequest, ReadOnly, Unavailable };
+
+enum class ServiceReport : uint8_t { System, Revenue, Reps, Top };
+
+// Decoded request; only the fields used by the op are meaningful
+struct ServiceRequest {
+    ServiceOp op = ServiceOp::GetCustomer;
+    uint32_t id = 0;
+    CustomerKind kind = CustomerKind::Regular;
+    ServiceReport report = ServiceReport::System;
+    uint32_t customerId = 0;
+    uint32_t repId = 0;
+    uint32_t minutes = 0;
+    uint32_t employees = 0;
+    uint32_t count = 0;
+    double annualContract = 0;
+    uint64_t sequence = 0;
+    std::string name;
+    std::string email;
+    std::string phone;
+    std::string group;
+    std::string content;
+    std::string detail;  // email subject or meeting location
+    std::vector<ServiceRequest> batch;
+};
+
+// Decoded response; only the fields returned by the op are meaningful
+struct ServiceResponse {
+    ServiceOp op = ServiceOp::GetCustomer;
+    uint32_t id = 0;
+    ServiceStatus status = ServiceStatus::Ok;
+    uint32_t value = 0;  // new customer or rep id, or number of snapshot frames
+    uint64_t sequence = 0;
+    CustomerKind kind = CustomerKind::Regular;
+    uint32_t repId = 0;
+    uint32_t minutes = 0;
+    std::string name;
+    std::string email;
+    std::string phone;
+    std::string text;  // report output
+    ReportSummary summary;
+    std::vector<ServiceResponse> batch;
+};
+
+// True for requests that change the CRM and are shipped to read replicas
+inline bool isMutatingServiceOp(ServiceOp op) {
+    return op == ServiceOp::CreateCustomer || op == ServiceOp::CreateRep || op == ServiceOp::Assign || 
+           op == ServiceOp::RecordCall || op == ServiceOp::RecordEmail || op == ServiceOp::RecordMeeting;
+}
+
+// Size of the complete frame (header included) at the front of a buffer,
+// 0 if more bytes are needed, or SIZE_MAX if the declared length is too large
+size_t serviceFrameSize(const char* data, size_t size);
+
+// Append one framed request or response to a buffer
+void encodeServiceRequest(const ServiceRequest& request, std::string& out);
+void encodeServiceResponse(const ServiceResponse& response, std::string& out);
+
+// Decode the payload of a frame (without its length header); false if malformed
+bool decodeServiceRequest(const char* payload, size_t size, ServiceRequest& request);
+bool decodeServiceResponse(const char* payload, size_t size, ServiceResponse& response);
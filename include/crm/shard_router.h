@@ -0,0 +1,104 @@
+// Front end for customers partitioned across several CRM servers
+// shard_router.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "crm/crm_client.h"
+#include "crm/crm_service.h"
+
+// Routes service requests to N shard servers, each holding part of the customers
+// Shard i (counting from 0) must hand out customer ids i + 1, i + 1 + N, ...
+// (see CRM::setCustomerIdSpace and `crm_server --shard i/N`), so a customer's
+// shard follows from its id. New customers go to the shard picked by a hash of
+// their email address (their name if it is empty). Every rep exists on every
+// shard: CreateRep goes to all of them, and since each sees the same creations
+// in the same order they hand out the same rep ids. CreateRep is only sent once
+// every shard is connected; if a shard still fails to create the rep while
+// others did, or the shards return different ids, it is answered with
+// Unavailable and from then on every request naming a rep is too, because the
+// same id may now mean different reps on different shards. Reports are gathered as
+// Summary requests from every shard and merged (see ReportSummary); the rep
+// report lists each rep's customers shard by shard. Subscribe is not supported.
+//
+// The requests read from a connection in one go are grouped per shard and sent
+// to each as one Batch, all shards first and then all replies, so a round costs
+// one concurrent round trip per shard involved. Shard connections are opened on
+// first use. Rounds run on the server's event loop, so every connect, send and
+// receive is limited to the shard timeout; requests whose shard cannot be
+// reached or does not answer in time are answered with Unavailable, and the
+// connection is retried in the next round.
+class ShardRouter : public ServiceHandler {
+private:
+    static constexpr size_t kAllShards = SIZE_MAX;
+    
+    struct Shard {
+        std::string host;
+        uint16_t port = 0;
+        CrmClient client;
+        ServiceRequest batch;      // requests for this shard in the current round
+        ServiceResponse response;
+        bool failed = false;       // the current round trip failed
+    };
+    
+    // A request, or a batch item, waiting for shard responses
+    struct Pending {
+        const ServiceRequest* request;
+        ServiceResponse* response;
+        size_t shard;  // kAllShards if sent to every shard
+        size_t item;   // index in the shard's batch, or in broadcastItems for every shard
+    };
+    
+    std::vector<std::unique_ptr<Shard>> shards;
+    bool repIdsDiverged = false;  // a rep was created on only some shards
+    
+    // Reused across rounds
+    std::vector<ServiceRequest> requests;
+    std::vector<bool> decoded;
+    std::vector<ServiceResponse> responses;
+    std::vector<Pending> pending;
+    std::vector<size_t> broadcastItems;
+    
+    // Answer locally or queue a request for its shard(s)
+    void route(const ServiceRequest& request, ServiceResponse& response);
+    
+    // Queue a request for one shard, or for every shard with kAllShards
+    void forward(const ServiceRequest& request, ServiceResponse& response, size_t shard);
+    
+    // Connect to every shard that is not connected yet; false if any is unreachable
+    bool connectAll();
+    
+    // Send every shard its batch and read back the replies
+    void roundTrip();
+    
+    // Fill in the response of a request from its shards' replies
+    void complete(const Pending& entry);
+    
+    // Fill in a CreateRep response, checking that every shard created the rep with the same id
+    void completeCreateRep(const Pending& entry);
+
+public:
+    static constexpr int kDefaultTimeoutMs = 1000;
+    
+    explicit ShardRouter(const std::vector<std::pair<std::string, uint16_t>>& addresses, 
+                         int timeoutMs = kDefaultTimeoutMs);
+    
+    size_t getShardCount() const { return shards.size(); }
+    
+    // Whether rep ids may mean different reps on different shards (see above)
+    bool haveRepIdsDiverged() const { return repIdsDiverged; }
+    
+    // Shard holding a customer id, given shard i hands out ids i + 1, i + 1 + N, ...
+    size_t shardOfCustomer(uint32_t customerId) const { return (customerId - 1) % shards.size(); }
+    
+    // Shard a new customer is created on
+    size_t shardForNewCustomer(const ServiceRequest& request) const;
+    
+    size_t handleFrames(const char* data, size_t size, std::string& output, uint64_t* followFrom) override;
+};
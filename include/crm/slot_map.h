@@ -0,0 +1,102 @@
+// Generational slot map used to store customers and sales reps
+// slot_map.h
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Generational handle into a SlotMap: the low 24 bits select the slot and the
+// high 8 bits must match the slot's generation, so stale handles resolve to nothing
+template <typename Tag>
+class Handle {
+private:
+    uint32_t value;
+
+public:
+    Handle() : value(0) {}
+    Handle(uint32_t index, uint32_t generation) : value((generation << 24) | index) {}
+    
+    uint32_t index() const { return value & 0xFFFFFF; }
+    uint32_t generation() const { return value >> 24; }
+    uint32_t raw() const { return value; }
+    bool isNull() const { return value == 0; }
+    
+    bool operator==(const Handle& other) const { return value == other.value; }
+    bool operator!=(const Handle& other) const { return value != other.value; }
+};
+
+// Slot map with generational handles
+// Objects live in a deque of slots, so they are stored in large contiguous
+// blocks and never move once created; freed slots are reused and their
+// generation bumped so outstanding handles to the old object become invalid.
+template <typename T, typename Tag = T>
+class SlotMap {
+public:
+    using HandleType = Handle<Tag>;
+    static constexpr uint32_t kMaxSlots = 1u << 24;
+
+private:
+    struct Slot {
+        std::optional<T> value;
+        uint32_t generation = 1;
+    };
+    
+    std::deque<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    size_t count = 0;
+
+public:
+    // Construct a new object in place and return its handle
+    template <typename... Args>
+    HandleType emplace(Args&&... args) {
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            if (slots.size() >= kMaxSlots)
+                throw std::length_error("SlotMap capacity exceeded");
+            index = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        slots[index].value.emplace(std::forward<Args>(args)...);
+        count++;
+        return HandleType(index, slots[index].generation);
+    }
+    
+    // Resolve a handle, returning nullptr if it is null or stale
+    T* get(HandleType handle) {
+        if (handle.isNull() || handle.index() >= slots.size())
+            return nullptr;
+        Slot& slot = slots[handle.index()];
+        return slot.value && slot.generation == handle.generation() ? &*slot.value : nullptr;
+    }
+    
+    const T* get(HandleType handle) const {
+        return const_cast<SlotMap*>(this)->get(handle);
+    }
+    
+    // Destroy the object behind a handle
+    bool erase(HandleType handle) {
+        if (!get(handle))
+            return false;
+        Slot& slot = slots[handle.index()];
+        slot.value.reset();
+        slot.generation = slot.generation == 0xFF ? 1 : slot.generation + 1;
+        freeSlots.push_back(handle.index());
+        count--;
+        return true;
+    }
+    
+    size_t size() const { return count; }
+    
+    // Bytes held by the slots themselves, including freed ones
+    size_t getMemoryUsage() const {
+        return slots.size() * sizeof(Slot) + freeSlots.capacity() * sizeof(uint32_t);
+    }
+};
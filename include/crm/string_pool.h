@@ -0,0 +1,62 @@
+// Interned string storage shared by customer and interaction fields
+// string_pool.h
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Process-wide pool of interned strings
+// Each distinct value is stored once and identified by a 32-bit id; id 0 is
+// the empty string. Values are kept in a deque so references stay valid.
+class StringPool {
+private:
+    mutable std::shared_mutex mutex;
+    std::deque<std::string> values;
+    std::unordered_map<std::string_view, uint32_t> ids;  // views into values
+
+public:
+    StringPool() { intern(""); }
+    
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+    
+    // The pool shared by all interned fields
+    static StringPool& global();
+    
+    // Id for a value, adding it to the pool if it is new
+    uint32_t intern(std::string_view value);
+    
+    const std::string& lookup(uint32_t id) const;
+    
+    size_t size() const;
+    
+    // Approximate heap bytes held by the pool
+    size_t getMemoryUsage() const;
+};
+
+// A string field stored as an id into the global StringPool
+class InternedString {
+private:
+    uint32_t id;
+
+public:
+    InternedString() : id(0) {}
+    InternedString(const std::string& value) : id(StringPool::global().intern(value)) {}
+    
+    uint32_t getId() const { return id; }
+    const std::string& str() const { return StringPool::global().lookup(id); }
+    operator const std::string&() const { return str(); }
+    
+    bool operator==(const InternedString& other) const { return id == other.id; }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const InternedString& value) {
+    return out << value.str();
+}
@@ -0,0 +1,41 @@
+// Compression for interaction content
+// text_codec.h
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// LZ77-style text codec with a built-in dictionary
+// The format follows LZ4 sequences: a token byte (literal length in the high
+// nibble, match length - 4 in the low nibble, 15 meaning "more length bytes
+// follow"), the literals, then a 2-byte little-endian match offset. Matches
+// may reach back into a fixed dictionary of common CRM phrases that is
+// conceptually placed in front of the input, which is what makes short
+// interaction notes compress at all.
+class TextCodec {
+private:
+    static constexpr size_t kMinMatch = 4;
+    static constexpr int kHashBits = 12;
+    
+    static const std::string& dictionary();
+    
+    static uint32_t read32(const char* p);
+    
+    static size_t hash(uint32_t value) {
+        return (value * 2654435761u) >> (32 - kHashBits);
+    }
+    
+    static void writeLength(std::string& out, size_t length);
+    
+    static bool readLength(const std::string& in, size_t& pos, size_t& length);
+    
+    static void writeSequence(std::string& out, const char* literals, size_t literalLength,
+                              size_t offset, size_t matchLength);
+
+public:
+    static std::string compress(const std::string& input);
+    
+    // Decode compressed text; returns false if the input is corrupt
+    static bool decompress(const std::string& input, std::string& output);
+};
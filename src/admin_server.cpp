@@ -0,0 +1,254 @@
+// Local admin endpoint for inspecting a running CRM
+// admin_server.cpp
+
+#include "crm/admin_server.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "crm/crm.h"
+#include "crm/logger.h"
+#include "crm/metrics.h"
+
+namespace {
+
+std::vector<std::string> splitWords(const std::string& line) {
+    std::istringstream in(line);
+    std::vector<std::string> words;
+    std::string word;
+    while (in >> word)
+        words.push_back(word);
+    return words;
+}
+
+// Write the whole buffer, retrying on short writes
+bool writeAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+const char* const kHelp =
+    "commands:\n"
+    "  help\n"
+    "  metrics [text|json]\n"
+    "  counts [json]\n"
+    "  memory [json]\n"
+    "  report system|revenue|reps|top [k]\n";
+
+}  // namespace
+
+bool AdminServer::start(const std::string& path) {
+    if (running)
+        return false;
+    
+    sockaddr_un address{};
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        CRM_LOG(LogLevel::Warning, "Admin socket path is empty or too long: " << path);
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        CRM_LOG(LogLevel::Warning, "Could not create admin socket: " << std::strerror(errno));
+        return false;
+    }
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(fd, 8) < 0) {
+        CRM_LOG(LogLevel::Warning, "Could not listen on " << path << ": " << std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    
+    listenFd = fd;
+    socketPath = path;
+    running = true;
+    worker = std::thread(&AdminServer::run, this);
+    return true;
+}
+
+void AdminServer::stop() {
+    if (!running.exchange(false))
+        return;
+    if (worker.joinable())
+        worker.join();
+    ::close(listenFd);
+    listenFd = -1;
+    ::unlink(socketPath.c_str());
+}
+
+void AdminServer::run() {
+    while (running) {
+        pollfd entry{listenFd, POLLIN, 0};
+        int ready = ::poll(&entry, 1, kPollMillis);
+        if (ready <= 0)
+            continue;
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+            continue;
+        serveConnection(fd);
+        ::close(fd);
+    }
+}
+
+void AdminServer::serveConnection(int fd) {
+    // A slow or silent client must not hold up the admin thread for long
+    timeval timeout{1, 0};
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    
+    std::string line;
+    char buffer[256];
+    while (line.size() < kMaxCommand && line.find('\n') == std::string::npos) {
+        ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        line.append(buffer, static_cast<size_t>(n));
+    }
+    size_t end = line.find('\n');
+    if (end != std::string::npos)
+        line.resize(end);
+    writeAll(fd, handleCommand(line));
+}
+
+std::string AdminServer::handleCommand(const std::string& line) const {
+    std::vector<std::string> words = splitWords(line);
+    if (words.empty() || words[0] == "help")
+        return kHelp;
+    
+    const std::string& command = words[0];
+    std::string argument = words.size() > 1 ? words[1] : "";
+    if (command == "metrics")
+        return handleMetrics(argument);
+    if (command == "counts")
+        return handleCounts(argument);
+    if (command == "memory")
+        return handleMemory(argument);
+    if (command == "report")
+        return handleReport(argument, words.size() > 2 ? words[2] : "");
+    return "error: unknown command '" + command + "'\n" + kHelp;
+}
+
+std::string AdminServer::handleMetrics(const std::string& format) const {
+    if (format == "json")
+        return Metrics::instance().toJson() + "\n";
+    if (format.empty() || format == "text")
+        return Metrics::instance().toText();
+    return "error: unknown format '" + format + "'\n";
+}
+
+std::string AdminServer::handleCounts(const std::string& format) const {
+    std::map<std::string, int> counts;
+    {
+        std::lock_guard<std::mutex> lock(crmMutex);
+        counts = crm.countCustomersByType();
+    }
+    
+    std::ostringstream out;
+    bool json = format == "json";
+    out << (json ? "{" : "");
+    bool first = true;
+    for (const auto& pair : counts) {
+        if (json)
+            out << (first ? "" : ", ") << "\"" << pair.first << "\": " << pair.second;
+        else
+            out << pair.first << ": " << pair.second << "\n";
+        first = false;
+    }
+    out << (json ? "}\n" : "");
+    return out.str();
+}
+
+std::string AdminServer::handleMemory(const std::string& format) const {
+    CRM::MemoryUsage usage;
+    {
+        std::lock_guard<std::mutex> lock(crmMutex);
+        usage = crm.getMemoryUsage();
+    }
+    
+    const std::pair<const char*, size_t> fields[] = {
+        {"customers", usage.customers},
+        {"interactions", usage.interactions},
+        {"customer_table", usage.customerTable},
+        {"interaction_index", usage.interactionIndex},
+        {"duplicate_detector", usage.duplicateDetector},
+        {"loyalty_ledger", usage.loyaltyLedger},
+        {"ranking", usage.ranking},
+        {"report_versions", usage.reportVersions},
+        {"customer_history", usage.customerHistory},
+        {"sales_reps", usage.salesReps},
+        {"string_pool", usage.stringPool},
+        {"total", usage.total()},
+        {"archived_on_disk", usage.archivedOnDisk},
+    };
+    
+    std::ostringstream out;
+    bool json = format == "json";
+    out << (json ? "{" : "");
+    bool first = true;
+    for (const auto& field : fields) {
+        if (json)
+            out << (first ? "" : ", ") << "\"" << field.first << "\": " << field.second;
+        else
+            out << field.first << ": " << field.second << " bytes\n";
+        first = false;
+    }
+    out << (json ? "}\n" : "");
+    return out.str();
+}
+
+std::string AdminServer::handleReport(const std::string& name, const std::string& argument) const {
+    size_t k = 10;
+    if (name == "top" && !argument.empty()) {
+        // strtoul alone would accept a sign or leading spaces, wrapping "-1" to a huge count
+        char* end = nullptr;
+        errno = 0;
+        unsigned long value = std::strtoul(argument.c_str(), &end, 10);
+        if (!std::isdigit(static_cast<unsigned char>(argument[0])) || *end != '\0' || errno == ERANGE)
+            return "error: invalid count '" + argument + "'\n";
+        k = value;
+    }
+    if (name != "system" && name != "revenue" && name != "reps" && name != "top")
+        return "error: unknown report '" + name + "'\n";
+    
+    // Only pinning the snapshot needs the lock; the report is built from it
+    // while the CRM goes on changing
+    ReportVersions::Snapshot snapshot;
+    {
+        std::lock_guard<std::mutex> lock(crmMutex);
+        snapshot = crm.openReportSnapshot();
+    }
+    ReportSummary summary = snapshot.summarize(name == "top" ? k : 0, name == "reps");
+    snapshot.release();
+    
+    std::ostringstream out;
+    if (name == "system")
+        summary.writeSystemReport(out);
+    else if (name == "revenue")
+        summary.writeRevenueReport(out);
+    else if (name == "reps")
+        summary.writeInteractionTimeReports(out);
+    else
+        summary.writeTopCustomers(k, out);
+    return out.str();
+}
@@ -0,0 +1,109 @@
+// Background worker pool for campaign actions
+// campaign_scheduler.cpp
+
+#include "crm/campaign_scheduler.h"
+
+#include <algorithm>
+
+void CampaignScheduler::acquireToken() {
+    if (ratePerSecond <= 0)
+        return;
+    for (;;) {
+        std::chrono::duration<double> wait;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto now = std::chrono::steady_clock::now();
+            tokens = std::min(capacity, tokens + 
+                std::chrono::duration<double>(now - lastRefill).count() * ratePerSecond);
+            lastRefill = now;
+            if (tokens >= 1.0) {
+                tokens -= 1.0;
+                return;
+            }
+            wait = std::chrono::duration<double>((1.0 - tokens) / ratePerSecond);
+        }
+        std::this_thread::sleep_for(wait);
+    }
+}
+
+void CampaignScheduler::run() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty())
+                return;
+            job = queue.top();
+            queue.pop();
+            active++;
+        }
+        
+        acquireToken();
+        bool ok = true;
+        try {
+            job.action();
+        } catch (...) {
+            ok = false;
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        active--;
+        if (ok) {
+            stats.completed++;
+        } else if (++job.attempts < maxAttempts) {
+            stats.retried++;
+            queue.push(std::move(job));
+            jobAvailable.notify_one();
+        } else {
+            stats.failed++;
+        }
+        if (queue.empty() && active == 0)
+            idle.notify_all();
+    }
+}
+
+CampaignScheduler::CampaignScheduler(size_t workerCount, double maxActionsPerSecond, int maxAttempts)
+    : maxAttempts(std::max(maxAttempts, 1)), ratePerSecond(maxActionsPerSecond), 
+      capacity(std::max(1.0, maxActionsPerSecond)), tokens(capacity), 
+      lastRefill(std::chrono::steady_clock::now()) {
+    for (size_t i = 0; i < std::max<size_t>(workerCount, 1); ++i)
+        workers.emplace_back(&CampaignScheduler::run, this);
+}
+
+CampaignScheduler::~CampaignScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void CampaignScheduler::submit(int priority, std::function<void()> action) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stats.submitted == 0)
+            started = std::chrono::steady_clock::now();
+        queue.push({priority, nextSequence++, 0, std::move(action)});
+        stats.submitted++;
+        stats.maxQueueDepth = std::max(stats.maxQueueDepth, queue.size());
+    }
+    jobAvailable.notify_one();
+}
+
+void CampaignScheduler::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return queue.empty() && active == 0; });
+}
+
+CampaignScheduler::Stats CampaignScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats current = stats;
+    current.queueDepth = queue.size();
+    double elapsed = stats.submitted == 0 ? 0.0 : 
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    current.throughput = elapsed > 0 ? static_cast<double>(stats.completed) / elapsed : 0.0;
+    return current;
+}
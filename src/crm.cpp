@@ -0,0 +1,686 @@
+// CRM system facade
+// crm.cpp
+
+#include "crm/crm.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+#include "crm/logger.h"
+#include "crm/memory_usage.h"
+#include "crm/text_codec.h"
+
+void CRM::updateRanking(int customerId, int totalTime) {
+    auto it = rankedTimes.find(customerId);
+    if (it != rankedTimes.end()) {
+        if (it->second == totalTime)
+            return;
+        interactionRanking.erase({it->second, customerId});
+        it->second = totalTime;
+    } else {
+        rankedTimes.emplace(customerId, totalTime);
+    }
+    interactionRanking.insert({totalTime, customerId});
+}
+
+CustomerHandle CRM::findCustomerHandle(int customerId) const {
+    uint32_t row = customers.find(customerId);
+    return row != CustomerTable::npos ? customers.getHandles()[row] : CustomerHandle();
+}
+
+SalesRepresentative* CRM::findSalesRep(int repId) {
+    auto it = salesRepsById.find(repId);
+    return it != salesRepsById.end() ? repStore.get(it->second) : nullptr;
+}
+
+void CRM::detachFromRep(Customer* customer) {
+    if (auto current = findSalesRep(customer->getRepId())) {
+        // The rep moves its last customer into the freed position; the report rows follow
+        const Customer* last = current->getCustomers().empty()
+            ? nullptr : customerStore.get(current->getCustomers().back());
+        current->removeCustomer(customer->getId());
+        if (last && last != customer)
+            reportVersions.setRepSlot(customers.find(last->getId()),
+                                      reportVersions.getRepSlot(customers.find(customer->getId())));
+        repLoads.customerRemoved(current->getId());
+        repContractCents[current->getId()] -= contractCentsOf(customer->getId());
+    }
+    customer->setRepId(0);
+    setTableRepId(customer->getId(), 0);
+}
+
+void CRM::setTableRepId(int customerId, int repId, size_t repSlot) {
+    uint32_t row = customers.find(customerId);
+    customers.setRepId(row, repId);
+    reportVersions.setRepId(row, repId, static_cast<uint32_t>(repSlot));
+    customerHistory.record(customerId, CustomerHistory::Field::RepId, repId, historyClock());
+}
+
+void CRM::setTableInteractionTime(int customerId, int minutes) {
+    uint32_t row = customers.find(customerId);
+    customers.setInteractionTime(row, minutes);
+    reportVersions.setMinutes(row, minutes);
+}
+
+void CRM::moveCustomer(CustomerHandle handle, SalesRepresentative* rep) {
+    Customer* customer = customerStore.get(handle);
+    if (customer->getRepId() == rep->getId())
+        return;
+    detachFromRep(customer);
+    rep->addCustomer(handle);
+    customer->setRepId(rep->getId());
+    setTableRepId(customer->getId(), rep->getId(), rep->getCustomerCount() - 1);
+    repLoads.customerAdded(rep->getId());
+    repContractCents[rep->getId()] += contractCentsOf(customer->getId());
+}
+
+int64_t CRM::contractCentsOf(int customerId) const {
+    uint32_t row = customers.find(customerId);
+    return row != CustomerTable::npos ? toCents(customers.getContractValues()[row]) : 0;
+}
+
+std::map<std::string, int> CRM::countByGroup(CustomerKind kind) const {
+    std::unordered_map<uint32_t, int> counts;
+    const auto& kinds = customers.getKinds();
+    const auto& groups = customers.getGroupIds();
+    for (uint32_t row = 0; row < customers.size(); ++row) {
+        if (kinds[row] == kind)
+            counts[groups[row]]++;
+    }
+    return resolveGroups(counts);
+}
+
+std::map<std::string, int> CRM::resolveGroups(const std::unordered_map<uint32_t, int>& counts) {
+    std::map<std::string, int> result;
+    for (const auto& entry : counts)
+        result[StringPool::global().lookup(entry.first)] = entry.second;
+    return result;
+}
+
+void CRM::applyScoringRules(Customer& customer) const {
+    int employees = customer.getKind() == CustomerKind::Corporate 
+        ? static_cast<const CorporateCustomer&>(customer).getNumberOfEmployees() : 0;
+    customer.setInteractionMultiplier(scoringRules.multiplierFor(customer.getKind(), employees));
+}
+
+void CRM::registerCustomer(CustomerHandle handle) {
+    Customer* customer = customerStore.get(handle);
+    customer->setObserver(this);
+    customer->setArchive(&interactionArchive);
+    applyScoringRules(*customer);
+    customers.add(*customer, handle);
+    reportVersions.add({customer->getId(), customer->getRepId(), 0, customer->calculateTotalInteractionTime(),
+                        customer->getKind(), 0, customer->getName()});
+    customerHistory.addCustomer(customer->getId(), historyClock());
+    updateRanking(customer->getId(), customer->calculateTotalInteractionTime());
+    duplicateDetector.addCustomer(customer->getId(), customer->getName(), 
+                                  customer->getEmail(), customer->getPhone());
+}
+
+CRM::CRM() : nextCustomerId(1), nextSalesRepId(1) {
+    // Materialize committed loyalty batches onto the VIP customers
+    loyaltyLedger.setCommitCallback([this](int customerId, double points) {
+        Customer* customer = findCustomer(customerId);
+        if (customer && customer->getKind() == CustomerKind::VIP)
+            static_cast<VIPCustomer*>(customer)->applyLedgerPoints(points);
+    });
+}
+
+void CRM::onInteractionAdded(const Customer& customer, const Interaction& interaction) {
+    interactionIndex.addInteraction(customer.getId(), customer.getInteractionCount() - 1,
+                                    interaction.getSearchableText());
+    if (interaction.getDuration() != 0) {
+        if (deferRanking) {
+            rankingDirty.push_back(customer.getId());
+        } else {
+            updateRanking(customer.getId(), customer.calculateTotalInteractionTime());
+            setTableInteractionTime(customer.getId(), customer.calculateTotalInteractionTime());
+        }
+        repLoads.recordMinutes(customer.getRepId(), interaction.getDuration());
+    }
+}
+
+void CRM::onCustomerUpdated(const Customer& customer) {
+    uint32_t row = customers.find(customer.getId());
+    if (customer.getKind() == CustomerKind::VIP) {
+        double points = static_cast<const VIPCustomer&>(customer).getLoyaltyPoints();
+        customers.setLoyaltyPoints(row, points);
+        customerHistory.record(customer.getId(), CustomerHistory::Field::LoyaltyPoints, 
+                               LoyaltyLedger::toFixed(points), historyClock());
+    } else if (customer.getKind() == CustomerKind::Corporate) {
+        double amount = static_cast<const CorporateCustomer&>(customer).getAnnualContract();
+        int64_t delta = toCents(amount) - contractCentsOf(customer.getId());
+        totalContractCents += delta;
+        if (customer.getRepId() != 0)
+            repContractCents[customer.getRepId()] += delta;
+        customers.setContractValue(row, amount);
+        reportVersions.setContractCents(row, toCents(amount));
+        customerHistory.record(customer.getId(), CustomerHistory::Field::ContractValue, 
+                               toCents(amount), historyClock());
+    }
+}
+
+RegularCustomer* CRM::createRegularCustomer(
+    const std::string& name, const std::string& email, 
+    const std::string& phone, const std::string& segment) {
+    OperationTimer timer(Operation::CreateRegularCustomer);
+    
+    CustomerHandle handle;
+    auto customer = customerStore.create<RegularCustomer>(
+        handle, takeCustomerId(), name, email, phone, segment);
+    registerCustomer(handle);
+    return customer;
+}
+
+VIPCustomer* CRM::createVIPCustomer(
+    const std::string& name, const std::string& email, 
+    const std::string& phone, const std::string& accountManager) {
+    OperationTimer timer(Operation::CreateVIPCustomer);
+    
+    CustomerHandle handle;
+    auto customer = customerStore.create<VIPCustomer>(
+        handle, takeCustomerId(), name, email, phone, accountManager);
+    registerCustomer(handle);
+    return customer;
+}
+
+CorporateCustomer* CRM::createCorporateCustomer(
+    const std::string& name, const std::string& email, 
+    const std::string& phone, const std::string& companyName,
+    int numberOfEmployees, double annualContract) {
+    OperationTimer timer(Operation::CreateCorporateCustomer);
+    
+    CustomerHandle handle;
+    auto customer = customerStore.create<CorporateCustomer>(
+        handle, takeCustomerId(), name, email, phone, companyName, 
+        numberOfEmployees, annualContract);
+    registerCustomer(handle);
+    customer->notifyUpdated();
+    return customer;
+}
+
+SalesRepresentative* CRM::createSalesRepresentative(const std::string& name) {
+    OperationTimer timer(Operation::CreateSalesRepresentative);
+    RepHandle handle = repStore.emplace(nextSalesRepId++, name, &customerStore);
+    SalesRepresentative* rep = repStore.get(handle);
+    rep->setLoyaltyLedger(&loyaltyLedger);
+    rep->setScoringRules(&scoringRules);
+    salesReps.push_back(handle);
+    salesRepsById[rep->getId()] = handle;
+    repLoads.addRep(rep->getId());
+    reportVersions.addRep(rep->getId(), rep->getName());
+    return rep;
+}
+
+bool CRM::getCustomerAsOf(int customerId, time_t at, CustomerHistory::Version& version) const {
+    OperationTimer timer(Operation::GetCustomerAsOf);
+    return customerHistory.getVersion(customerId, at, version);
+}
+
+std::vector<const Customer*> CRM::getCustomers() const {
+    OperationTimer timer(Operation::GetCustomers);
+    std::vector<const Customer*> result;
+    result.reserve(customers.size());
+    for (CustomerHandle handle : customers.getHandles())
+        result.push_back(customerStore.get(handle));
+    std::sort(result.begin(), result.end(), [](const Customer* a, const Customer* b) {
+        return a->getId() < b->getId();
+    });
+    return result;
+}
+
+std::vector<const SalesRepresentative*> CRM::getSalesRepresentatives() const {
+    OperationTimer timer(Operation::GetSalesRepresentatives);
+    std::vector<const SalesRepresentative*> result;
+    result.reserve(salesReps.size());
+    for (RepHandle handle : salesReps)
+        result.push_back(repStore.get(handle));
+    return result;
+}
+
+bool CRM::setCustomerIdSpace(int firstId, int stride) {
+    if (nextCustomerId != 1 || customerIdStride != 1 || firstId < 1 || stride < 1)
+        return false;
+    nextCustomerId = firstId;
+    customerIdStride = stride;
+    return true;
+}
+
+void CRM::assignCustomerToRep(int customerId, int repId) {
+    OperationTimer timer(Operation::AssignCustomerToRep);
+    Customer* customer = findCustomer(customerId);
+    SalesRepresentative* rep = findSalesRep(repId);
+    
+    // Assign if both exist
+    if (customer && rep) {
+        moveCustomer(findCustomerHandle(customerId), rep);
+        std::cout << "Customer " << customer->getName() 
+                  << " assigned to " << rep->getName() << std::endl;
+    } else {
+        std::cout << "Customer or Sales Rep not found." << std::endl;
+    }
+}
+
+int CRM::autoAssignCustomer(int customerId) {
+    OperationTimer timer(Operation::AutoAssignCustomer);
+    if (repLoads.empty()) {
+        std::cout << "No sales representatives available." << std::endl;
+        return 0;
+    }
+    int repId = repLoads.leastLoadedRep();
+    assignCustomerToRep(customerId, repId);
+    return repId;
+}
+
+size_t CRM::rebalanceCustomers() {
+    OperationTimer timer(Operation::RebalanceCustomers);
+    size_t moved = 0;
+    size_t limit = customers.size();
+    while (moved < limit) {
+        // Recent minutes stay with a rep, so moving customers can only even out portfolio sizes
+        auto from = findSalesRep(repLoads.largestPortfolioRep());
+        auto to = findSalesRep(repLoads.smallestPortfolioRep());
+        if (!from || !to || from == to || from->getCustomerCount() <= to->getCustomerCount() + 1)
+            break;
+        moveCustomer(from->getCustomers().back(), to);
+        moved++;
+    }
+    std::cout << "Rebalanced " << moved << " customers across " 
+              << salesReps.size() << " sales reps" << std::endl;
+    return moved;
+}
+
+void CRM::removeSalesRepresentative(int repId) {
+    OperationTimer timer(Operation::RemoveSalesRepresentative);
+    auto rep = findSalesRep(repId);
+    if (!rep) {
+        std::cout << "Sales Rep not found." << std::endl;
+        return;
+    }
+    
+    RepHandle handle = salesRepsById[repId];
+    repLoads.removeRep(repId);
+    repContractCents.erase(repId);
+    salesRepsById.erase(repId);
+    salesReps.erase(std::find(salesReps.begin(), salesReps.end(), handle));
+    reportVersions.removeRep(repId);
+    
+    auto portfolio = rep->getCustomers();
+    for (CustomerHandle customer : portfolio) {
+        Customer* orphan = customerStore.get(customer);
+        orphan->setRepId(0);
+        setTableRepId(orphan->getId(), 0);
+        if (auto to = findSalesRep(repLoads.leastLoadedRep()))
+            moveCustomer(customer, to);
+    }
+    std::cout << "Sales rep " << rep->getName() << " removed, " 
+              << portfolio.size() << " customers reassigned" << std::endl;
+    repStore.erase(handle);
+}
+
+bool CRM::reassignCustomer(int customerId, int newRepId) {
+    OperationTimer timer(Operation::ReassignCustomer);
+    CustomerHandle customer = findCustomerHandle(customerId);
+    auto rep = findSalesRep(newRepId);
+    if (!customerStore.get(customer) || !rep)
+        return false;
+    moveCustomer(customer, rep);
+    return true;
+}
+
+size_t CRM::reassignCustomers(const std::vector<std::pair<int, int>>& moves) {
+    OperationTimer timer(Operation::ReassignCustomers);
+    size_t applied = 0;
+    for (const auto& move : moves) {
+        if (reassignCustomer(move.first, move.second))
+            applied++;
+    }
+    std::cout << "Reassigned " << applied << " of " << moves.size() << " customers" << std::endl;
+    return applied;
+}
+
+void CRM::unassignCustomer(int customerId) {
+    OperationTimer timer(Operation::UnassignCustomer);
+    if (auto customer = findCustomer(customerId))
+        detachFromRep(customer);
+}
+
+bool CRM::removeCustomer(int customerId) {
+    OperationTimer timer(Operation::RemoveCustomer);
+    CustomerHandle handle = findCustomerHandle(customerId);
+    Customer* customer = customerStore.get(handle);
+    if (!customer)
+        return false;
+    
+    detachFromRep(customer);
+    totalContractCents -= contractCentsOf(customerId);
+    customerStore.erase(handle);
+    reportVersions.remove(customers.find(customerId));
+    customers.remove(customerId);
+    customerHistory.removeCustomer(customerId, historyClock());
+    
+    auto ranked = rankedTimes.find(customerId);
+    interactionRanking.erase({ranked->second, customerId});
+    rankedTimes.erase(ranked);
+    
+    interactionIndex.removeCustomer(customerId);
+    duplicateDetector.removeCustomer(customerId);
+    return true;
+}
+
+void CRM::displayAllCustomers() const {
+    OperationTimer timer(Operation::DisplayAllCustomers);
+    if (customers.empty()) {
+        std::cout << "No customers in the system." << std::endl;
+        return;
+    }
+    
+    std::cout << "All Customers:" << std::endl;
+    for (uint32_t row = 0; row < customers.size(); ++row) {
+        std::cout << "ID: " << customers.getIds()[row] 
+                  << ", Name: " << customers.getName(row)
+                  << ", Type: " << customerKindName(customers.getKinds()[row]) << std::endl;
+    }
+}
+
+void CRM::displayAllSalesReps() const {
+    OperationTimer timer(Operation::DisplayAllSalesReps);
+    if (salesReps.empty()) {
+        std::cout << "No sales representatives in the system." << std::endl;
+        return;
+    }
+    
+    std::cout << "All Sales Representatives:" << std::endl;
+    for (RepHandle handle : salesReps) {
+        const SalesRepresentative* rep = repStore.get(handle);
+        std::cout << "ID: " << rep->getId() 
+                  << ", Name: " << rep->getName() << std::endl;
+    }
+}
+
+std::vector<int> CRM::filterCustomers(CustomerKind kind, int minMinutes) const {
+    OperationTimer timer(Operation::FilterCustomers);
+    std::vector<int> result;
+    const auto& kinds = customers.getKinds();
+    const auto& times = customers.getInteractionTimes();
+    for (uint32_t row = 0; row < customers.size(); ++row) {
+        if (kinds[row] == kind && times[row] >= minMinutes)
+            result.push_back(customers.getIds()[row]);
+    }
+    return result;
+}
+
+double CRM::getTotalLoyaltyPoints() const {
+    OperationTimer timer(Operation::GetTotalLoyaltyPoints);
+    double total = 0;
+    for (double points : customers.getLoyaltyPoints())
+        total += points;
+    return total;
+}
+
+size_t CRM::compressInteractionsOlderThan(int days) {
+    OperationTimer timer(Operation::CompressInteractions);
+    time_t cutoff = time(nullptr) - static_cast<time_t>(days) * 24 * 60 * 60;
+    size_t saved = 0;
+    for (CustomerHandle handle : customers.getHandles())
+        saved += customerStore.get(handle)->compressInteractions(cutoff);
+    return saved;
+}
+
+bool CRM::loadScoringRules(const std::string& path) {
+    OperationTimer timer(Operation::LoadScoringRules);
+    ScoringRules rules;
+    std::string error;
+    if (!rules.loadFromFile(path, error)) {
+        std::cout << "Could not load scoring rules: " << error << std::endl;
+        return false;
+    }
+    scoringRules = rules;
+    
+    for (CustomerHandle handle : customers.getHandles()) {
+        Customer* customer = customerStore.get(handle);
+        applyScoringRules(*customer);
+        setTableInteractionTime(customer->getId(), customer->calculateTotalInteractionTime());
+        updateRanking(customer->getId(), customer->calculateTotalInteractionTime());
+    }
+    return true;
+}
+
+bool CRM::addLoyaltyPoints(int customerId, double points, LoyaltyReason reason) {
+    OperationTimer timer(Operation::AddLoyaltyPoints);
+    const Customer* customer = findCustomer(customerId);
+    if (!customer || customer->getKind() != CustomerKind::VIP)
+        return false;
+    loyaltyLedger.accrue(customerId, points, reason);
+    return true;
+}
+
+double CRM::getLoyaltyBalance(int customerId) {
+    OperationTimer timer(Operation::GetLoyaltyBalance);
+    loyaltyLedger.commit();
+    return loyaltyLedger.getBalance(customerId);
+}
+
+std::vector<LoyaltyLedger::Entry> CRM::getLoyaltyHistory(int customerId) {
+    OperationTimer timer(Operation::GetLoyaltyHistory);
+    loyaltyLedger.commit();
+    return loyaltyLedger.getHistory(customerId);
+}
+
+size_t CRM::renewContracts(const std::vector<ContractRenewal>& renewals) {
+    OperationTimer timer(Operation::RenewContracts);
+    size_t renewed = 0;
+    for (const ContractRenewal& renewal : renewals) {
+        Customer* customer = findCustomer(renewal.customerId);
+        if (!customer || customer->getKind() != CustomerKind::Corporate)
+            continue;
+        static_cast<CorporateCustomer*>(customer)->applyRenewal(renewal.amount, renewal.effectiveDate);
+        renewed++;
+    }
+    std::cout << "Renewed " << renewed << " of " << renewals.size() << " contracts" << std::endl;
+    return renewed;
+}
+
+double CRM::getAnnualContractValue(int repId) const {
+    OperationTimer timer(Operation::GetAnnualContractValue);
+    auto it = repContractCents.find(repId);
+    return it != repContractCents.end() ? static_cast<double>(it->second) / 100 : 0.0;
+}
+
+void CRM::generateRevenueReport(std::ostream& out) const {
+    OperationTimer timer(Operation::GenerateRevenueReport);
+    openReportSnapshot().summarize(0, false).writeRevenueReport(out);
+}
+
+void CRM::scheduleCampaign(CampaignScheduler& scheduler, std::ostream& out) const {
+    OperationTimer timer(Operation::ScheduleCampaign);
+    for (RepHandle handle : salesReps)
+        repStore.get(handle)->scheduleCustomerActions(scheduler, out);
+}
+
+bool CRM::enableInteractionTiering(const std::string& segmentPath) {
+    OperationTimer timer(Operation::EnableInteractionTiering);
+    if (interactionArchive.isOpen()) {
+        std::cout << "Interaction tiering is already enabled" << std::endl;
+        return false;
+    }
+    if (!interactionArchive.open(segmentPath)) {
+        std::cout << "Could not open interaction archive " << segmentPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+size_t CRM::spillInteractionsOlderThan(int days) {
+    OperationTimer timer(Operation::SpillInteractions);
+    time_t cutoff = time(nullptr) - static_cast<time_t>(days) * 24 * 60 * 60;
+    size_t spilled = 0;
+    for (CustomerHandle handle : customers.getHandles())
+        spilled += customerStore.get(handle)->spillInteractions(cutoff);
+    return spilled;
+}
+
+size_t CRM::recordInteractions(const std::vector<InteractionRecord>& records, std::vector<bool>& recorded) {
+    OperationTimer timer(Operation::RecordInteractions);
+    recorded.assign(records.size(), false);
+    deferRanking = true;
+    size_t count = 0;
+    for (size_t begin = 0; begin < records.size();) {
+        size_t end = begin + 1;
+        while (end < records.size() && records[end].repId == records[begin].repId)
+            end++;
+        if (SalesRepresentative* rep = findSalesRep(records[begin].repId))
+            count += rep->recordInteractions(records, begin, end, recorded);
+        begin = end;
+    }
+    deferRanking = false;
+    
+    std::sort(rankingDirty.begin(), rankingDirty.end());
+    rankingDirty.erase(std::unique(rankingDirty.begin(), rankingDirty.end()), rankingDirty.end());
+    for (int customerId : rankingDirty) {
+        int totalTime = findCustomer(customerId)->calculateTotalInteractionTime();
+        updateRanking(customerId, totalTime);
+        setTableInteractionTime(customerId, totalTime);
+    }
+    rankingDirty.clear();
+    return count;
+}
+
+std::map<std::string, int> CRM::countMeetingsByLocation() const {
+    OperationTimer timer(Operation::CountMeetingsByLocation);
+    std::unordered_map<uint32_t, int> counts;
+    for (CustomerHandle handle : customers.getHandles()) {
+        customerStore.get(handle)->forEachInteraction([&counts](const Interaction& interaction) {
+            if (auto meeting = dynamic_cast<const Meeting*>(&interaction))
+                counts[meeting->getLocationId()]++;
+        });
+    }
+    return resolveGroups(counts);
+}
+
+void CRM::displaySearchResults(const std::string& query) const {
+    OperationTimer timer(Operation::DisplaySearchResults);
+    auto hits = searchInteractions(query);
+    std::cout << "Search results for '" << query << "': " << hits.size() << std::endl;
+    for (const auto& hit : hits) {
+        if (auto customer = findCustomer(hit.customerId)) {
+            std::cout << customer->getName() << ": ";
+            customer->displayInteraction(hit.interactionIndex);
+        }
+    }
+}
+
+std::vector<const Customer*> CRM::getTopCustomersByInteractionTime(size_t k) const {
+    OperationTimer timer(Operation::GetTopCustomers);
+    std::vector<const Customer*> top;
+    top.reserve(std::min(k, interactionRanking.size()));
+    for (auto it = interactionRanking.begin(); it != interactionRanking.end() && top.size() < k; ++it)
+        top.push_back(findCustomer(it->second));
+    return top;
+}
+
+void CRM::displayTopCustomers(size_t k, std::ostream& out) const {
+    OperationTimer timer(Operation::DisplayTopCustomers);
+    getReportSummary(k, false).writeTopCustomers(k, out);
+}
+
+std::vector<DuplicateDetector::Candidate> CRM::findPossibleDuplicates(
+    const std::string& name, const std::string& email, 
+    const std::string& phone, double threshold) const {
+    OperationTimer timer(Operation::FindPossibleDuplicates);
+    return duplicateDetector.checkCustomer(name, email, phone, threshold);
+}
+
+std::map<std::string, int> CRM::countCustomersByType() const {
+    OperationTimer timer(Operation::CountCustomersByType);
+    // Reads only the kind column
+    int kindCounts[3] = {0, 0, 0};
+    for (CustomerKind kind : customers.getKinds())
+        kindCounts[static_cast<int>(kind)]++;
+    
+    std::map<std::string, int> counts;
+    for (int kind = 0; kind < 3; ++kind) {
+        if (kindCounts[kind] > 0)
+            counts[customerKindName(static_cast<CustomerKind>(kind))] = kindCounts[kind];
+    }
+    return counts;
+}
+
+CRM::MemoryUsage CRM::getMemoryUsage() const {
+    OperationTimer timer(Operation::GetMemoryUsage);
+    MemoryUsage usage{};
+    usage.customers = customerStore.getMemoryUsage();
+    for (CustomerHandle handle : customers.getHandles()) {
+        const Customer* customer = customerStore.get(handle);
+        usage.customers += customer->getMemoryUsage();
+        usage.interactions += customer->getInteractionMemoryUsage();
+    }
+    usage.customerTable = customers.getMemoryUsage();
+    usage.interactionIndex = interactionIndex.getMemoryUsage();
+    usage.duplicateDetector = duplicateDetector.getMemoryUsage();
+    usage.loyaltyLedger = loyaltyLedger.getMemoryUsage();
+    
+    // Red-black tree nodes carry three pointers and a colour besides the value
+    usage.ranking = interactionRanking.size() * (sizeof(std::pair<int, int>) + 4 * sizeof(void*)) + 
+                    hashTableMemory(rankedTimes);
+    
+    usage.salesReps = repStore.getMemoryUsage() + vectorMemory(salesReps) + 
+                      hashTableMemory(salesRepsById) + hashTableMemory(repContractCents);
+    for (RepHandle handle : salesReps)
+        usage.salesReps += repStore.get(handle)->getMemoryUsage();
+    
+    usage.reportVersions = reportVersions.getMemoryUsage();
+    usage.customerHistory = customerHistory.getMemoryUsage();
+    usage.stringPool = StringPool::global().getMemoryUsage();
+    usage.archivedOnDisk = interactionArchive.getSize();
+    return usage;
+}
+
+ReportSummary CRM::getReportSummary(size_t topK, bool withRepCustomers) const {
+    OperationTimer timer(Operation::GetReportSummary);
+    ReportSummary summary;
+    for (CustomerKind kind : customers.getKinds())
+        summary.customersByKind[static_cast<int>(kind)]++;
+    for (int minutes : customers.getInteractionTimes())
+        summary.interactionMinutes += minutes;
+    summary.contractCents = totalContractCents;
+    
+    auto totalsOf = [](const Customer& customer) {
+        return ReportSummary::CustomerTotals{customer.getId(), customer.getName(), customer.getKind(), 
+                                             customer.calculateTotalInteractionTime()};
+    };
+    summary.reps.reserve(salesReps.size());
+    for (RepHandle handle : salesReps) {
+        const SalesRepresentative* rep = repStore.get(handle);
+        ReportSummary::RepTotals totals;
+        totals.name = rep->getName();
+        auto cents = repContractCents.find(rep->getId());
+        totals.contractCents = cents != repContractCents.end() ? cents->second : 0;
+        if (withRepCustomers) {
+            totals.customers.reserve(rep->getCustomerCount());
+            for (CustomerHandle customer : rep->getCustomers())
+                totals.customers.push_back(totalsOf(*customerStore.get(customer)));
+        }
+        summary.reps.push_back(std::move(totals));
+    }
+    
+    for (const Customer* customer : getTopCustomersByInteractionTime(topK))
+        summary.top.push_back(totalsOf(*customer));
+    return summary;
+}
+
+ReportVersions::Snapshot CRM::openReportSnapshot() const {
+    OperationTimer timer(Operation::OpenReportSnapshot);
+    return reportVersions.openSnapshot();
+}
+
+void CRM::generateInteractionTimeReports(std::ostream& out) const {
+    OperationTimer timer(Operation::GenerateInteractionTimeReports);
+    openReportSnapshot().summarize(0, true).writeInteractionTimeReports(out);
+}
+
+void CRM::generateSystemReport(std::ostream& out) const {
+    OperationTimer timer(Operation::GenerateSystemReport);
+    openReportSnapshot().summarize(0, false).writeSystemReport(out);
+}
@@ -0,0 +1,123 @@
+// Blocking client for the CRM service protocol
+// crm_client.cpp
+
+#include "crm/crm_client.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+
+bool CrmClient::waitReady(short events, Deadline deadline) const {
+    for (;;) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0)
+            return false;
+        pollfd entry{fd, events, 0};
+        int ready = ::poll(&entry, 1, static_cast<int>(left));
+        if (ready < 0 && errno == EINTR)
+            continue;
+        return ready > 0;
+    }
+}
+
+bool CrmClient::connect(const std::string& host, uint16_t port) {
+    close();
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1)
+        return false;
+    
+    fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | (timeoutMs > 0 ? SOCK_NONBLOCK : 0), 0);
+    if (fd < 0)
+        return false;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        // A non-blocking connect completes in the background; wait for it up to the timeout
+        int error = errno;
+        socklen_t length = sizeof(error);
+        if (error != EINPROGRESS || !waitReady(POLLOUT, deadlineFromNow()) ||
+            ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0) {
+            close();
+            return false;
+        }
+    }
+    int noDelay = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    return true;
+}
+
+void CrmClient::close() {
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+    output.clear();
+    input.clear();
+    inputOffset = 0;
+}
+
+uint32_t CrmClient::send(ServiceRequest request) {
+    request.id = nextId++;
+    encodeServiceRequest(request, output);
+    return request.id;
+}
+
+bool CrmClient::flush() {
+    Deadline deadline = deadlineFromNow();
+    size_t sent = 0;
+    while (sent < output.size()) {
+        ssize_t n = ::send(fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && waitReady(POLLOUT, deadline))
+            continue;
+        if (n <= 0)
+            return false;
+        sent += static_cast<size_t>(n);
+    }
+    output.clear();
+    return true;
+}
+
+bool CrmClient::receive(ServiceResponse& response) {
+    if (fd < 0 || !flush())
+        return false;
+    Deadline deadline = deadlineFromNow();
+    while (true) {
+        size_t frame = serviceFrameSize(input.data() + inputOffset, input.size() - inputOffset);
+        if (frame == SIZE_MAX)
+            return false;
+        if (frame != 0) {
+            bool decoded = decodeServiceResponse(input.data() + inputOffset + 4, frame - 4, response);
+            inputOffset += frame;
+            if (inputOffset == input.size()) {
+                input.clear();
+                inputOffset = 0;
+            }
+            return decoded;
+        }
+        
+        char buffer[16 * 1024];
+        ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && waitReady(POLLIN, deadline))
+            continue;
+        if (n <= 0)
+            return false;
+        input.erase(0, inputOffset);
+        inputOffset = 0;
+        input.append(buffer, static_cast<size_t>(n));
+    }
+}
+
+bool CrmClient::call(const ServiceRequest& request, ServiceResponse& response) {
+    send(request);
+    return receive(response);
+}
@@ -0,0 +1,297 @@
+// Network server exposing the CRM service protocol
+// crm_server.cpp
+
+#include "crm/crm_server.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include "crm/logger.h"
+#include "crm/replication_log.h"
+
+bool CrmServer::start(const std::string& host, uint16_t listenPort) {
+    if (running)
+        return false;
+    
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(listenPort);
+    if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        CRM_LOG(LogLevel::Warning, "Invalid server address: " << host);
+        return false;
+    }
+    
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    if (listenFd < 0 ||
+        ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) < 0 ||
+        ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listenFd, SOMAXCONN) < 0) {
+        CRM_LOG(LogLevel::Warning, "Could not listen on " << host << ":" << listenPort 
+                << ": " << std::strerror(errno));
+        closeAll();
+        return false;
+    }
+    socklen_t length = sizeof(address);
+    ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &length);
+    port = ntohs(address.sin_port);
+    
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        CRM_LOG(LogLevel::Warning, "Could not create event loop: " << std::strerror(errno));
+        closeAll();
+        return false;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = wakeFd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    
+    running = true;
+    worker = std::thread(&CrmServer::run, this);
+    return true;
+}
+
+void CrmServer::stop() {
+    if (!running.exchange(false))
+        return;
+    uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+    if (worker.joinable())
+        worker.join();
+    closeAll();
+}
+
+void CrmServer::closeAll() {
+    for (const auto& entry : connections)
+        ::close(entry.first);
+    connections.clear();
+    followers.clear();
+    connectionCount = 0;
+    for (int* fd : {&listenFd, &epollFd, &wakeFd}) {
+        if (*fd >= 0)
+            ::close(*fd);
+        *fd = -1;
+    }
+}
+
+void CrmServer::run() {
+    epoll_event events[kMaxEvents];
+    while (running) {
+        int ready = ::epoll_wait(epollFd, events, kMaxEvents, -1);
+        if (ready < 0 && errno != EINTR) {
+            CRM_LOG(LogLevel::Warning, "Event loop failed: " << std::strerror(errno));
+            break;
+        }
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd)
+                continue;
+            if (fd == listenFd) {
+                acceptConnections();
+                continue;
+            }
+            
+            auto it = connections.find(fd);
+            if (it == connections.end())
+                continue;
+            Connection& connection = *it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(fd);
+                continue;
+            }
+            if ((events[i].events & EPOLLIN) && connection.reading)
+                handleReadable(connection);
+            else if (events[i].events & EPOLLOUT) {
+                if (!flushOutput(connection))
+                    closeConnection(fd);
+                else
+                    updateInterest(connection);
+            }
+        }
+        if (!followers.empty())
+            shipLog();
+    }
+}
+
+void CrmServer::acceptConnections() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                CRM_LOG(LogLevel::Warning, "Could not accept connection: " << std::strerror(errno));
+            return;
+        }
+        
+        // Responses are small and latency-sensitive
+        int noDelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            continue;
+        }
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connections[fd] = std::move(connection);
+        connectionCount = connections.size();
+    }
+}
+
+void CrmServer::handleReadable(Connection& connection) {
+    // Read what is available now; level-triggered epoll reports the rest later
+    char buffer[kReadChunk];
+    while (true) {
+        ssize_t n = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            connection.input.append(buffer, static_cast<size_t>(n));
+            if (static_cast<size_t>(n) < sizeof(buffer))
+                break;
+            continue;
+        }
+        if (n == 0) {
+            connection.peerClosed = true;
+            break;
+        }
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
+        closeConnection(connection.fd);
+        return;
+    }
+    
+    // Followers only receive; anything they send is ignored
+    if (connection.follower) {
+        connection.input.clear();
+    } else {
+        size_t consumed;
+        uint64_t followFrom = 0;
+        {
+            std::lock_guard<std::mutex> lock(crmMutex);
+            consumed = handler->handleFrames(connection.input.data(), connection.input.size(), connection.output, 
+                                             log ? &followFrom : nullptr);
+        }
+        if (consumed == SIZE_MAX) {
+            CRM_LOG(LogLevel::Warning, "Dropping connection that sent an oversized frame");
+            closeConnection(connection.fd);
+            return;
+        }
+        connection.input.erase(0, consumed);
+        if (followFrom != 0) {
+            connection.follower = true;
+            connection.nextSequence = followFrom;
+            connection.input.clear();
+            followers.push_back(connection.fd);
+        }
+    }
+    
+    if (!flushOutput(connection)) {
+        closeConnection(connection.fd);
+        return;
+    }
+    updateInterest(connection);
+}
+
+void CrmServer::shipLog() {
+    // Closing a connection edits the follower list, so walk a copy
+    std::vector<int> current = followers;
+    std::lock_guard<std::mutex> lock(crmMutex);
+    for (int fd : current) {
+        auto it = connections.find(fd);
+        if (it == connections.end())
+            continue;
+        Connection& connection = *it->second;
+        size_t pending = connection.output.size() - connection.outputOffset;
+        if (connection.nextSequence == log->getNextSequence() || pending >= kMaxPendingOutput)
+            continue;
+        if (!log->canResumeFrom(connection.nextSequence)) {
+            CRM_LOG(LogLevel::Warning, "Dropping follower that fell behind the replication log at sequence " 
+                    << connection.nextSequence);
+            closeConnection(fd);
+            continue;
+        }
+        connection.nextSequence = log->copyFrom(connection.nextSequence, connection.output, 
+                                                kMaxPendingOutput - pending);
+        if (!flushOutput(connection))
+            closeConnection(fd);
+        else
+            updateInterest(connection);
+    }
+}
+
+bool CrmServer::flushOutput(Connection& connection) {
+    while (connection.outputOffset < connection.output.size()) {
+        ssize_t n = ::send(connection.fd, connection.output.data() + connection.outputOffset, 
+                           connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if (n > 0) {
+            connection.outputOffset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        return false;
+    }
+    connection.output.clear();
+    connection.outputOffset = 0;
+    return true;
+}
+
+void CrmServer::updateInterest(Connection& connection) {
+    size_t pending = connection.output.size() - connection.outputOffset;
+    if (connection.peerClosed && pending == 0) {
+        closeConnection(connection.fd);
+        return;
+    }
+    
+    bool reading = !connection.peerClosed && pending < kMaxPendingOutput;
+    bool writing = pending > 0;
+    if (reading == connection.reading && writing == connection.writing)
+        return;
+    
+    epoll_event event{};
+    event.events = (reading ? static_cast<uint32_t>(EPOLLIN) : 0u) | (writing ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    event.data.fd = connection.fd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+    connection.reading = reading;
+    connection.writing = writing;
+}
+
+void CrmServer::closeConnection(int fd) {
+    ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(fd);
+    followers.erase(std::remove(followers.begin(), followers.end(), fd), followers.end());
+    connectionCount = connections.size();
+}
+
+void raiseDescriptorLimit() {
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
@@ -0,0 +1,255 @@
+// Executes CRM service protocol requests
+// crm_service.cpp
+
+#include "crm/crm_service.h"
+
+#include <cstdint>
+#include <sstream>
+
+#include "crm/crm.h"
+#include "crm/replication_log.h"
+
+void CrmService::execute(const ServiceRequest& request, ServiceResponse& response) {
+    response.op = request.op;
+    response.id = request.id;
+    response.status = ServiceStatus::Ok;
+    if (readOnly && isMutatingServiceOp(request.op)) {
+        response.status = ServiceStatus::ReadOnly;
+        return;
+    }
+    
+    switch (request.op) {
+        case ServiceOp::CreateCustomer: {
+            const Customer* customer = nullptr;
+            if (request.kind == CustomerKind::Regular)
+                customer = crm.createRegularCustomer(request.name, request.email, request.phone, request.group);
+            else if (request.kind == CustomerKind::VIP)
+                customer = crm.createVIPCustomer(request.name, request.email, request.phone, request.group);
+            else
+                customer = crm.createCorporateCustomer(request.name, request.email, request.phone, request.group, 
+                                                       static_cast<int>(request.employees), request.annualContract);
+            response.value = static_cast<uint32_t>(customer->getId());
+            break;
+        }
+        case ServiceOp::CreateRep:
+            response.value = static_cast<uint32_t>(crm.createSalesRepresentative(request.name)->getId());
+            break;
+        case ServiceOp::Assign:
+            if (!crm.reassignCustomer(static_cast<int>(request.customerId), static_cast<int>(request.repId)))
+                response.status = ServiceStatus::NotFound;
+            break;
+        case ServiceOp::RecordCall:
+        case ServiceOp::RecordEmail:
+        case ServiceOp::RecordMeeting: {
+            SalesRepresentative* rep = crm.getSalesRepresentative(static_cast<int>(request.repId));
+            if (!rep) {
+                response.status = ServiceStatus::NotFound;
+                break;
+            }
+            int customerId = static_cast<int>(request.customerId);
+            int minutes = static_cast<int>(request.minutes);
+            bool recorded;
+            if (request.op == ServiceOp::RecordCall)
+                recorded = rep->recordCall(customerId, request.content, minutes);
+            else if (request.op == ServiceOp::RecordEmail)
+                recorded = rep->recordEmail(customerId, request.content, request.detail);
+            else
+                recorded = rep->recordMeeting(customerId, request.content, request.detail, minutes);
+            if (!recorded)
+                response.status = ServiceStatus::NotFound;
+            break;
+        }
+        case ServiceOp::GetCustomer: {
+            const Customer* customer = crm.getCustomer(static_cast<int>(request.customerId));
+            if (!customer) {
+                response.status = ServiceStatus::NotFound;
+                break;
+            }
+            response.kind = customer->getKind();
+            response.repId = static_cast<uint32_t>(customer->getRepId());
+            response.minutes = static_cast<uint32_t>(customer->calculateTotalInteractionTime());
+            response.name = customer->getName();
+            response.email = customer->getEmail();
+            response.phone = customer->getPhone();
+            break;
+        }
+        case ServiceOp::Report: {
+            std::ostringstream out;
+            if (request.report == ServiceReport::System)
+                crm.generateSystemReport(out);
+            else if (request.report == ServiceReport::Revenue)
+                crm.generateRevenueReport(out);
+            else if (request.report == ServiceReport::Reps)
+                crm.generateInteractionTimeReports(out);
+            else
+                crm.displayTopCustomers(request.count, out);
+            response.text = out.str();
+            break;
+        }
+        case ServiceOp::Summary:
+            response.summary = crm.getReportSummary(request.report == ServiceReport::Top ? request.count : 0, 
+                                                    request.report == ServiceReport::Reps);
+            break;
+        case ServiceOp::Batch:
+            executeBatch(request.batch, response.batch);
+            break;
+        default:
+            response.status = ServiceStatus::BadRequest;
+            break;
+    }
+    if (log && response.status == ServiceStatus::Ok && isMutatingServiceOp(request.op))
+        log->append(request);
+}
+
+void CrmService::executeBatch(const std::vector<ServiceRequest>& items, std::vector<ServiceResponse>& responses) {
+    responses.resize(items.size());
+    for (size_t i = 0; i < items.size();) {
+        if (readOnly || !isRecordOp(items[i].op)) {
+            execute(items[i], responses[i]);
+            i++;
+            continue;
+        }
+        
+        size_t end = i;
+        records.clear();
+        for (; end < items.size() && isRecordOp(items[end].op); ++end) {
+            const ServiceRequest& item = items[end];
+            InteractionKind kind = item.op == ServiceOp::RecordCall ? InteractionKind::Call : 
+                                   item.op == ServiceOp::RecordEmail ? InteractionKind::Email : InteractionKind::Meeting;
+            records.push_back({static_cast<int>(item.repId), static_cast<int>(item.customerId), kind, 
+                               static_cast<int>(item.minutes), item.content, item.detail});
+        }
+        crm.recordInteractions(records, recorded);
+        for (size_t j = 0; j < records.size(); ++j, ++i) {
+            responses[i].op = items[i].op;
+            responses[i].id = items[i].id;
+            responses[i].status = recorded[j] ? ServiceStatus::Ok : ServiceStatus::NotFound;
+            if (log && recorded[j])
+                log->append(items[i]);
+        }
+    }
+}
+
+uint32_t CrmService::writeSnapshot(std::string& out) const {
+    uint32_t frames = 0;
+    ServiceRequest item;
+    auto emit = [&](ServiceOp op) {
+        item.op = op;
+        item.id = frames++;
+        encodeServiceRequest(item, out);
+    };
+    
+    for (const SalesRepresentative* rep : crm.getSalesRepresentatives()) {
+        item.name = rep->getName();
+        emit(ServiceOp::CreateRep);
+    }
+    
+    std::vector<const Customer*> customers = crm.getCustomers();
+    for (const Customer* customer : customers) {
+        item.kind = customer->getKind();
+        item.name = customer->getName();
+        item.email = customer->getEmail();
+        item.phone = customer->getPhone();
+        item.employees = 0;
+        item.annualContract = 0;
+        if (auto regular = dynamic_cast<const RegularCustomer*>(customer)) {
+            item.group = regular->getSegment();
+        } else if (auto vip = dynamic_cast<const VIPCustomer*>(customer)) {
+            item.group = vip->getAccountManager();
+        } else {
+            auto corporate = static_cast<const CorporateCustomer*>(customer);
+            item.group = corporate->getCompanyName();
+            item.employees = static_cast<uint32_t>(corporate->getNumberOfEmployees());
+            item.annualContract = corporate->getAnnualContract();
+        }
+        emit(ServiceOp::CreateCustomer);
+    }
+    
+    for (const Customer* customer : customers) {
+        if (customer->getRepId() == 0)
+            continue;
+        item.customerId = static_cast<uint32_t>(customer->getId());
+        item.repId = static_cast<uint32_t>(customer->getRepId());
+        emit(ServiceOp::Assign);
+    }
+    
+    // Interactions can only be recorded through a rep, so those of unassigned
+    // customers (left behind when their rep was removed) cannot be replayed
+    for (const Customer* customer : customers) {
+        if (customer->getRepId() == 0)
+            continue;
+        item.customerId = static_cast<uint32_t>(customer->getId());
+        item.repId = static_cast<uint32_t>(customer->getRepId());
+        customer->forEachInteraction([&](const Interaction& interaction) {
+            item.content = interaction.getContent();
+            item.minutes = static_cast<uint32_t>(interaction.getDuration());
+            if (auto email = dynamic_cast<const Email*>(&interaction)) {
+                item.detail = email->getSubject();
+                emit(ServiceOp::RecordEmail);
+            } else if (auto meeting = dynamic_cast<const Meeting*>(&interaction)) {
+                item.detail = meeting->getLocation();
+                emit(ServiceOp::RecordMeeting);
+            } else {
+                emit(ServiceOp::RecordCall);
+            }
+        });
+    }
+    return frames;
+}
+
+uint64_t CrmService::subscribe(const ServiceRequest& request, std::string& output) {
+    response.op = request.op;
+    response.id = request.id;
+    response.status = ServiceStatus::Ok;
+    response.value = 0;
+    response.sequence = request.sequence;
+    
+    if (!log || (request.sequence != 0 && !log->canResumeFrom(request.sequence))) {
+        response.status = ServiceStatus::NotFound;
+        encodeServiceResponse(response, output);
+        return 0;
+    }
+    if (request.sequence != 0) {
+        encodeServiceResponse(response, output);
+        return request.sequence;
+    }
+    
+    // The response carries the frame count, so the snapshot is built first
+    snapshot.clear();
+    response.value = writeSnapshot(snapshot);
+    response.sequence = log->getNextSequence();
+    encodeServiceResponse(response, output);
+    output += snapshot;
+    return response.sequence;
+}
+
+size_t CrmService::handleFrames(const char* data, size_t size, std::string& output, uint64_t* followFrom) {
+    size_t consumed = 0;
+    while (true) {
+        size_t frame = serviceFrameSize(data + consumed, size - consumed);
+        if (frame == SIZE_MAX)
+            return SIZE_MAX;
+        if (frame == 0)
+            return consumed;
+        
+        const char* payload = data + consumed + 4;
+        if (decodeServiceRequest(payload, frame - 4, request)) {
+            if (request.op == ServiceOp::Subscribe && followFrom) {
+                uint64_t next = subscribe(request, output);
+                consumed += frame;
+                if (next != 0) {
+                    *followFrom = next;
+                    return consumed;
+                }
+                continue;
+            }
+            execute(request, response);
+        } else {
+            response.op = request.op;
+            response.id = request.id;
+            response.status = ServiceStatus::BadRequest;
+        }
+        encodeServiceResponse(response, output);
+        consumed += frame;
+    }
+}
@@ -0,0 +1,175 @@
+// Customer class hierarchy
+// customer.cpp
+
+#include "crm/customer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <utility>
+
+#include "crm/memory_usage.h"
+#include "crm/scoring_rules.h"
+
+Customer::Customer(int id, const std::string& name, const std::string& email, const std::string& phone,
+                   CustomerKind kind)
+    : id(id), name(name), email(email), phone(phone), type(customerKindName(kind)), kind(kind),
+      interactionMultiplier(ScoringRules::defaults().multiplierFor(kind)) {}
+
+void Customer::addInteraction(std::unique_ptr<Interaction> interaction) {
+    totalDuration += interaction->getDuration();
+    interactions.push_back(std::move(interaction));
+    if (observer)
+        observer->onInteractionAdded(*this, *interactions.back());
+}
+
+void Customer::notifyUpdated() const {
+    if (observer)
+        observer->onCustomerUpdated(*this);
+}
+
+size_t Customer::spillInteractions(time_t olderThan) {
+    if (!archive || !archive->isOpen())
+        return 0;
+    
+    // The interactions only leave memory once they are safely in the archive
+    uint64_t start = archive->getSize();
+    size_t count = 0;
+    bool written = true;
+    while (written && count < interactions.size() && interactions[count]->getTimestamp() < olderThan) {
+        const Interaction& interaction = *interactions[count];
+        uint64_t offset = 0;
+        written = archive->append(interaction, offset);
+        if (written) {
+            archived.push_back({offset, interaction.getTimestamp()});
+            count++;
+        }
+    }
+    if (count != 0 && written)
+        written = archive->flush();
+    if (!written) {
+        CRM_LOG(LogLevel::Warning, "Could not archive interactions of " << name << "; keeping them in memory");
+        archived.resize(archived.size() - count);
+        archive->truncate(start);
+        return 0;
+    }
+    interactions.erase(interactions.begin(), interactions.begin() + count);
+    return count;
+}
+
+void Customer::forEachInteractionBetween(time_t from, time_t to, 
+                                         const std::function<void(const Interaction&)>& visit) const {
+    auto first = std::lower_bound(archived.begin(), archived.end(), from,
+        [](const ArchivedInteraction& entry, time_t time) { return entry.timestamp < time; });
+    for (auto it = first; it != archived.end() && it->timestamp <= to; ++it) {
+        if (auto interaction = loadArchived(it - archived.begin()))
+            visit(*interaction);
+    }
+    for (const auto& interaction : interactions) {
+        if (interaction->getTimestamp() >= from && interaction->getTimestamp() <= to)
+            visit(*interaction);
+    }
+}
+
+void Customer::forEachInteraction(const std::function<void(const Interaction&)>& visit) const {
+    forEachInteractionBetween(std::numeric_limits<time_t>::min(), 
+                              std::numeric_limits<time_t>::max(), visit);
+}
+
+void Customer::displayInteractions() const {
+    if (getInteractionCount() == 0) {
+        std::cout << "No interactions recorded for " << name << std::endl;
+        return;
+    }
+    
+    std::cout << "Interactions for " << name << " (" << type << "):" << std::endl;
+    forEachInteraction([](const Interaction& interaction) { interaction.display(); });
+}
+
+void Customer::displayInteractionsBetween(time_t from, time_t to) const {
+    std::cout << "Interactions for " << name << " (" << type << ") in range:" << std::endl;
+    forEachInteractionBetween(from, to, [](const Interaction& interaction) { interaction.display(); });
+}
+
+void Customer::displayInteraction(size_t ordinal) const {
+    if (ordinal < archived.size()) {
+        if (auto interaction = loadArchived(ordinal))
+            interaction->display();
+    } else if (ordinal - archived.size() < interactions.size()) {
+        interactions[ordinal - archived.size()]->display();
+    }
+}
+
+size_t Customer::compressInteractions(time_t olderThan) {
+    size_t saved = 0;
+    for (auto& interaction : interactions) {
+        if (interaction->getTimestamp() < olderThan)
+            saved += interaction->compressContent();
+    }
+    return saved;
+}
+
+size_t Customer::getMemoryUsage() const {
+    return stringMemory(name) + stringMemory(email) + stringMemory(phone) + stringMemory(type) + 
+           vectorMemory(archived);
+}
+
+size_t Customer::getInteractionMemoryUsage() const {
+    size_t bytes = vectorMemory(interactions);
+    for (const auto& interaction : interactions)
+        bytes += interaction->getMemoryUsage();
+    return bytes;
+}
+
+void RegularCustomer::performCustomerSpecificAction(std::ostream& out) const {
+    out << "Sending regular promotional materials to " << name << " in segment " << segment << std::endl;
+}
+
+VIPCustomer::VIPCustomer(int id, const std::string& name, const std::string& email, 
+                         const std::string& phone, const std::string& accountManager)
+    : Customer(id, name, email, phone, CustomerKind::VIP), 
+      accountManager(accountManager), loyaltyPoints(0) {}
+
+void VIPCustomer::performCustomerSpecificAction(std::ostream& out) const {
+    out << "Scheduling quarterly review with " << name 
+        << " and account manager " << accountManager << std::endl;
+}
+
+void VIPCustomer::addLoyaltyPoints(double points) {
+    loyaltyPoints += points;
+    CRM_LOG(LogLevel::Info, "Added " << points << " loyalty points to " << name 
+                            << ". Total: " << loyaltyPoints);
+    notifyUpdated();
+}
+
+void VIPCustomer::applyLedgerPoints(double points) {
+    loyaltyPoints += points;
+    notifyUpdated();
+}
+
+CorporateCustomer::CorporateCustomer(int id, const std::string& name, const std::string& email, 
+                                    const std::string& phone, const std::string& companyName, 
+                                    int numberOfEmployees, double annualContract)
+    : Customer(id, name, email, phone, CustomerKind::Corporate), companyName(companyName), 
+      numberOfEmployees(numberOfEmployees), annualContract(annualContract) {
+    // Corporate multiplier depends on company size
+    interactionMultiplier = ScoringRules::defaults().multiplierFor(CustomerKind::Corporate, numberOfEmployees);
+    contractHistory.push_back({annualContract, time(nullptr)});
+}
+
+void CorporateCustomer::performCustomerSpecificAction(std::ostream& out) const {
+    out << "Arranging corporate training session for " << companyName 
+        << " with " << numberOfEmployees << " potential users" << std::endl;
+}
+
+void CorporateCustomer::renewContract(double newAmount) {
+    std::cout << "Renewing contract for " << companyName << ". Old amount: $" 
+              << annualContract << ", New amount: $" << newAmount << std::endl;
+    applyRenewal(newAmount, time(nullptr));
+}
+
+void CorporateCustomer::applyRenewal(double newAmount, time_t effectiveDate) {
+    annualContract = newAmount;
+    contractHistory.push_back({newAmount, effectiveDate});
+    notifyUpdated();
+}
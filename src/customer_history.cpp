@@ -0,0 +1,76 @@
+// Point-in-time history of audited customer fields
+// customer_history.cpp
+
+#include "crm/customer_history.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include "crm/loyalty_ledger.h"
+#include "crm/memory_usage.h"
+
+int64_t CustomerHistory::valueAt(const std::vector<Change>& changes, time_t at) {
+    auto next = std::upper_bound(changes.begin(), changes.end(), at,
+        [](time_t time, const Change& change) { return time < change.at; });
+    return next == changes.begin() ? 0 : std::prev(next)->value;
+}
+
+void CustomerHistory::addCustomer(int customerId, time_t at) {
+    Timeline& timeline = timelines[customerId];
+    timeline.created = at;
+    timeline.removed = std::numeric_limits<time_t>::max();
+}
+
+void CustomerHistory::removeCustomer(int customerId, time_t at) {
+    auto it = timelines.find(customerId);
+    if (it != timelines.end())
+        it->second.removed = std::max(at, it->second.created);
+}
+
+void CustomerHistory::record(int customerId, Field field, int64_t value, time_t at) {
+    auto it = timelines.find(customerId);
+    if (it == timelines.end())
+        return;
+    std::vector<Change>& changes = it->second.fields[static_cast<int>(field)];
+    
+    int64_t current = changes.empty() ? 0 : changes.back().value;
+    if (value == current)
+        return;
+    if (!changes.empty() && at <= changes.back().at) {
+        // Same second (or a clock that stepped back): the newer value wins, and
+        // an entry that ends up restoring the previous value is dropped
+        changes.back().value = value;
+        int64_t previous = changes.size() > 1 ? changes[changes.size() - 2].value : 0;
+        if (value == previous) {
+            changes.pop_back();
+            changeCount--;
+        }
+        return;
+    }
+    changes.push_back({at, value});
+    changeCount++;
+}
+
+bool CustomerHistory::getVersion(int customerId, time_t at, Version& version) const {
+    auto it = timelines.find(customerId);
+    if (it == timelines.end() || at < it->second.created || at >= it->second.removed)
+        return false;
+    
+    const Timeline& timeline = it->second;
+    version.repId = static_cast<int>(valueAt(timeline.fields[static_cast<int>(Field::RepId)], at));
+    version.loyaltyPoints = LoyaltyLedger::fromFixed(
+        valueAt(timeline.fields[static_cast<int>(Field::LoyaltyPoints)], at));
+    version.annualContract = static_cast<double>(
+        valueAt(timeline.fields[static_cast<int>(Field::ContractValue)], at)) / 100;
+    return true;
+}
+
+size_t CustomerHistory::getMemoryUsage() const {
+    size_t bytes = hashTableMemory(timelines);
+    for (const auto& entry : timelines) {
+        for (const auto& changes : entry.second.fields)
+            bytes += vectorMemory(changes);
+    }
+    return bytes;
+}
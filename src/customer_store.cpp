@@ -0,0 +1,87 @@
+// Customer storage: the slot-map registry and the structure-of-arrays table
+// customer_store.cpp
+
+#include "crm/customer_store.h"
+
+#include "crm/memory_usage.h"
+
+Customer* CustomerRegistry::get(CustomerHandle handle) {
+    CustomerVariant* customer = slots.get(handle);
+    return customer ? std::visit([](Customer& c) { return &c; }, *customer) : nullptr;
+}
+
+CustomerTable::StringRef CustomerTable::store(const std::string& text) {
+    StringRef ref{static_cast<uint32_t>(arena.size()), static_cast<uint32_t>(text.size())};
+    arena += text;
+    return ref;
+}
+
+void CustomerTable::compactArena() {
+    std::string compacted;
+    compacted.reserve(arena.size() - arenaGarbage);
+    for (auto* column : {&names, &emails}) {
+        for (StringRef& ref : *column) {
+            uint32_t offset = static_cast<uint32_t>(compacted.size());
+            compacted.append(arena, ref.offset, ref.length);
+            ref.offset = offset;
+        }
+    }
+    arena.swap(compacted);
+    arenaGarbage = 0;
+}
+
+void CustomerTable::add(const Customer& customer, CustomerHandle handle) {
+    rows[customer.getId()] = static_cast<uint32_t>(ids.size());
+    ids.push_back(customer.getId());
+    kinds.push_back(customer.getKind());
+    handles.push_back(handle);
+    repIds.push_back(customer.getRepId());
+    interactionTimes.push_back(customer.calculateTotalInteractionTime());
+    loyaltyPoints.push_back(0);
+    contractValues.push_back(0);
+    if (customer.getKind() == CustomerKind::Regular)
+        groupIds.push_back(static_cast<const RegularCustomer&>(customer).getSegmentId());
+    else if (customer.getKind() == CustomerKind::VIP)
+        groupIds.push_back(static_cast<const VIPCustomer&>(customer).getAccountManagerId());
+    else
+        groupIds.push_back(0);
+    names.push_back(store(customer.getName()));
+    emails.push_back(store(customer.getEmail()));
+}
+
+void CustomerTable::remove(int customerId) {
+    auto it = rows.find(customerId);
+    if (it == rows.end())
+        return;
+    uint32_t row = it->second;
+    rows.erase(it);
+    arenaGarbage += names[row].length + emails[row].length;
+    
+    if (row + 1 != ids.size())
+        rows[ids.back()] = row;
+    moveLast(ids, row);
+    moveLast(kinds, row);
+    moveLast(handles, row);
+    moveLast(repIds, row);
+    moveLast(interactionTimes, row);
+    moveLast(loyaltyPoints, row);
+    moveLast(contractValues, row);
+    moveLast(groupIds, row);
+    moveLast(names, row);
+    moveLast(emails, row);
+    
+    if (arenaGarbage > arena.size() / 2)
+        compactArena();
+}
+
+uint32_t CustomerTable::find(int customerId) const {
+    auto it = rows.find(customerId);
+    return it != rows.end() ? it->second : npos;
+}
+
+size_t CustomerTable::getMemoryUsage() const {
+    return vectorMemory(ids) + vectorMemory(kinds) + vectorMemory(handles) + vectorMemory(repIds) + 
+           vectorMemory(interactionTimes) + vectorMemory(loyaltyPoints) + vectorMemory(contractValues) + 
+           vectorMemory(groupIds) + vectorMemory(names) + vectorMemory(emails) + arena.capacity() + 
+           hashTableMemory(rows);
+}
@@ -0,0 +1,261 @@
+// Fuzzy duplicate-customer detection
+// duplicate_detector.cpp
+
+#include "crm/duplicate_detector.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "crm/memory_usage.h"
+
+uint64_t DuplicateDetector::mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t DuplicateDetector::hashString(const std::string& text) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (char c : text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string DuplicateDetector::normalizeName(const std::string& name) {
+    std::string result;
+    for (char ch : name) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        if (std::isalnum(c))
+            result += static_cast<char>(std::tolower(c));
+        else if (!result.empty() && result.back() != ' ')
+            result += ' ';
+    }
+    if (!result.empty() && result.back() == ' ')
+        result.pop_back();
+    return result;
+}
+
+std::string DuplicateDetector::normalizeEmail(const std::string& email) {
+    std::string result;
+    for (char ch : email) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        if (!std::isspace(c))
+            result += static_cast<char>(std::tolower(c));
+    }
+    return result;
+}
+
+std::string DuplicateDetector::normalizePhone(const std::string& phone) {
+    std::string digits;
+    for (char ch : phone) {
+        if (std::isdigit(static_cast<unsigned char>(ch)))
+            digits += ch;
+    }
+    return digits;
+}
+
+void DuplicateDetector::addShingles(std::vector<uint64_t>& shingles, char field, const std::string& text) {
+    std::string padded = " " + text + " ";
+    for (size_t i = 0; i + 3 <= padded.size(); ++i)
+        shingles.push_back(hashString(std::string(1, field) + padded.substr(i, 3)));
+}
+
+DuplicateDetector::Signature DuplicateDetector::computeSignature(const std::string& name, const std::string& email, 
+                                                                 const std::string& phone) {
+    std::vector<uint64_t> shingles;
+    addShingles(shingles, 'n', normalizeName(name));
+    addShingles(shingles, 'e', normalizeEmail(email));
+    addShingles(shingles, 'p', normalizePhone(phone));
+    
+    Signature signature;
+    signature.fill(UINT32_MAX);
+    for (uint64_t shingle : shingles) {
+        for (int i = 0; i < kHashes; ++i) {
+            uint32_t h = static_cast<uint32_t>(mix(shingle ^ (0x5851F42D4C957F2DULL * (i + 1))));
+            signature[i] = std::min(signature[i], h);
+        }
+    }
+    return signature;
+}
+
+uint64_t DuplicateDetector::bandKey(const Signature& signature, int band) {
+    uint64_t key = mix(static_cast<uint64_t>(band));
+    for (int r = 0; r < kRows; ++r)
+        key = mix(key ^ signature[band * kRows + r]);
+    return key;
+}
+
+std::vector<std::string> DuplicateDetector::exactKeysFor(const std::string& email, const std::string& phone) {
+    std::vector<std::string> keys;
+    std::string normalizedEmail = normalizeEmail(email);
+    std::string normalizedPhone = normalizePhone(phone);
+    if (!normalizedEmail.empty())
+        keys.push_back("e:" + normalizedEmail);
+    if (normalizedPhone.size() >= 7)
+        keys.push_back("p:" + normalizedPhone);
+    return keys;
+}
+
+double DuplicateDetector::similarity(const Signature& a, const Signature& b) {
+    int same = 0;
+    for (int i = 0; i < kHashes; ++i)
+        same += a[i] == b[i];
+    return static_cast<double>(same) / kHashes;
+}
+
+std::unordered_map<uint32_t, bool> DuplicateDetector::probe(const Signature& signature, 
+                                                            const std::vector<std::string>& keys) const {
+    std::unordered_map<uint32_t, bool> found;
+    for (int band = 0; band < kBands; ++band) {
+        auto it = bandBuckets.find(bandKey(signature, band));
+        if (it == bandBuckets.end() || it->second.size() > kMaxBucketSize)
+            continue;
+        for (uint32_t entry : it->second)
+            found.emplace(entry, false);
+    }
+    for (const auto& key : keys) {
+        auto it = exactKeys.find(key);
+        if (it == exactKeys.end())
+            continue;
+        // Score only a bounded share of an oversized bucket (a switchboard
+        // number), as findCandidatePairs chains rather than pairs it
+        size_t count = std::min(it->second.size(), kMaxBucketSize);
+        for (size_t i = 0; i < count; ++i)
+            found[it->second[i]] = true;
+    }
+    return found;
+}
+
+template <typename SlotOf>
+void DuplicateDetector::eraseFromBucket(std::vector<uint32_t>& bucket, uint32_t entry, SlotOf slotOf) {
+    uint32_t slot = slotOf(entry);
+    uint32_t moved = bucket.back();
+    bucket[slot] = moved;
+    slotOf(moved) = slot;
+    bucket.pop_back();
+}
+
+void DuplicateDetector::addCustomer(int customerId, const std::string& name, const std::string& email, 
+                                    const std::string& phone) {
+    uint32_t entry = static_cast<uint32_t>(entries.size());
+    entries.push_back({customerId, computeSignature(name, email, phone), true, {}, {}, {}});
+    entryByCustomer[customerId] = entry;
+    for (int band = 0; band < kBands; ++band) {
+        std::vector<uint32_t>& bucket = bandBuckets[bandKey(entries.back().signature, band)];
+        entries.back().bandSlots[band] = static_cast<uint32_t>(bucket.size());
+        bucket.push_back(entry);
+    }
+    
+    // Map nodes never move, so the entry can keep pointers to its exact buckets
+    std::vector<std::string> keys = exactKeysFor(email, phone);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto bucket = exactKeys.try_emplace(keys[i]).first;
+        entries.back().exactSlots[i] = static_cast<uint32_t>(bucket->second.size());
+        bucket->second.push_back(entry);
+        entries.back().exactBuckets[i] = &*bucket;
+    }
+}
+
+void DuplicateDetector::removeCustomer(int customerId) {
+    auto it = entryByCustomer.find(customerId);
+    if (it == entryByCustomer.end())
+        return;
+    uint32_t index = it->second;
+    Entry& entry = entries[index];
+    entry.active = false;
+    entryByCustomer.erase(it);
+    
+    for (int band = 0; band < kBands; ++band) {
+        auto bucket = bandBuckets.find(bandKey(entry.signature, band));
+        if (bucket == bandBuckets.end())
+            continue;
+        eraseFromBucket(bucket->second, index, 
+            [this, band](uint32_t member) -> uint32_t& { return entries[member].bandSlots[band]; });
+        if (bucket->second.empty())
+            bandBuckets.erase(bucket);
+    }
+    for (auto*& bucket : entry.exactBuckets) {
+        if (!bucket)
+            continue;
+        ExactKeys::value_type* key = bucket;
+        eraseFromBucket(bucket->second, index, [this, key](uint32_t member) -> uint32_t& {
+            Entry& other = entries[member];
+            return other.exactSlots[other.exactBuckets[0] == key ? 0 : 1];
+        });
+        if (bucket->second.empty())
+            exactKeys.erase(bucket->first);
+        bucket = nullptr;
+    }
+}
+
+std::vector<DuplicateDetector::Candidate> DuplicateDetector::checkCustomer(const std::string& name, const std::string& email, 
+                                                                           const std::string& phone, double threshold) const {
+    Signature signature = computeSignature(name, email, phone);
+    std::vector<Candidate> result;
+    for (const auto& match : probe(signature, exactKeysFor(email, phone))) {
+        const Entry& other = entries[match.first];
+        if (!other.active)
+            continue;
+        double score = similarity(signature, other.signature);
+        if (match.second || score >= threshold)
+            result.push_back({0, other.customerId, score, match.second});
+    }
+    std::sort(result.begin(), result.end(),
+        [](const Candidate& a, const Candidate& b) { return a.similarity > b.similarity; });
+    return result;
+}
+
+std::vector<DuplicateDetector::Candidate> DuplicateDetector::findCandidatePairs(double threshold) const {
+    std::unordered_map<uint64_t, bool> pairs;
+    auto addPair = [&pairs](uint32_t a, uint32_t b, bool exact) {
+        uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+        pairs[key] = pairs[key] || exact;
+    };
+    auto collect = [&addPair](const std::vector<uint32_t>& bucket, bool exact) {
+        if (bucket.size() > kMaxBucketSize) {
+            // An oversized band bucket says nothing; an oversized exact bucket
+            // is linked as a chain, which still connects every member
+            if (exact) {
+                for (size_t i = 1; i < bucket.size(); ++i)
+                    addPair(bucket[i - 1], bucket[i], true);
+            }
+            return;
+        }
+        for (size_t i = 0; i < bucket.size(); ++i) {
+            for (size_t j = i + 1; j < bucket.size(); ++j)
+                addPair(bucket[i], bucket[j], exact);
+        }
+    };
+    for (const auto& bucket : bandBuckets)
+        collect(bucket.second, false);
+    for (const auto& bucket : exactKeys)
+        collect(bucket.second, true);
+    
+    std::vector<Candidate> result;
+    for (const auto& pair : pairs) {
+        const Entry& first = entries[pair.first >> 32];
+        const Entry& second = entries[pair.first & 0xFFFFFFFFULL];
+        if (!first.active || !second.active)
+            continue;
+        double score = similarity(first.signature, second.signature);
+        if (pair.second || score >= threshold)
+            result.push_back({first.customerId, second.customerId, score, pair.second});
+    }
+    std::sort(result.begin(), result.end(), [](const Candidate& a, const Candidate& b) {
+        return a.similarity != b.similarity ? a.similarity > b.similarity : a.firstId < b.firstId;
+    });
+    return result;
+}
+
+size_t DuplicateDetector::getMemoryUsage() const {
+    size_t bytes = vectorMemory(entries) + hashTableMemory(entryByCustomer) + 
+                   hashTableMemory(bandBuckets) + hashTableMemory(exactKeys);
+    for (const auto& bucket : bandBuckets)
+        bytes += vectorMemory(bucket.second);
+    for (const auto& bucket : exactKeys)
+        bytes += stringMemory(bucket.first) + vectorMemory(bucket.second);
+    return bytes;
+}
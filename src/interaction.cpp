@@ -0,0 +1,73 @@
+// Interaction class hierarchy
+// interaction.cpp
+
+#include "crm/interaction.h"
+
+#include <iostream>
+#include <utility>
+
+#include "crm/memory_usage.h"
+#include "crm/text_codec.h"
+
+Interaction::Interaction(const std::string& content, time_t timestamp) 
+    : timestamp(timestamp), content(content) {
+    tm* ltm = localtime(&timestamp);
+    
+    char buffer[80];
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", ltm);
+    date = std::string(buffer);
+}
+
+size_t Interaction::compressContent() {
+    if (compressed)
+        return 0;
+    std::string packed = TextCodec::compress(content);
+    if (packed.size() >= content.size())
+        return 0;
+    size_t saved = content.capacity() - packed.size();
+    content = std::move(packed);
+    content.shrink_to_fit();
+    compressed = true;
+    return saved;
+}
+
+std::string Interaction::getContent() const {
+    if (!compressed)
+        return content;
+    std::string text;
+    TextCodec::decompress(content, text);
+    return text;
+}
+
+size_t Interaction::getMemoryUsage() const {
+    return sizeof(*this) + stringMemory(date) + stringMemory(content) + stringMemory(type);
+}
+
+Call::Call(const std::string& content, int duration, time_t timestamp) 
+    : Interaction(content, timestamp), duration(duration) {
+    type = "Call";
+}
+
+void Call::display() const {
+    std::cout << "Call on " << date << " (Duration: " << duration << " minutes): " << getContent() << std::endl;
+}
+
+Email::Email(const std::string& content, const std::string& subject, time_t timestamp) 
+    : Interaction(content, timestamp), subject(subject) {
+    type = "Email";
+}
+
+void Email::display() const {
+    std::cout << "Email on " << date << " (Subject: " << subject << "): " << getContent() << std::endl;
+}
+
+Meeting::Meeting(const std::string& content, const std::string& location, int duration,
+                 time_t timestamp) 
+    : Interaction(content, timestamp), location(location), duration(duration) {
+    type = "Meeting";
+}
+
+void Meeting::display() const {
+    std::cout << "Meeting on " << date << " at " << location 
+              << " (Duration: " << duration << " minutes): " << getContent() << std::endl;
+}
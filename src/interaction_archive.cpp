@@ -0,0 +1,123 @@
+// On-disk archive for interactions spilled out of memory
+// interaction_archive.cpp
+
+#include "crm/interaction_archive.h"
+
+#include <algorithm>
+
+void InteractionArchive::putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i)
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+void InteractionArchive::putString(std::string& out, const std::string& value) {
+    putU32(out, static_cast<uint32_t>(value.size()));
+    out += value;
+}
+
+uint32_t InteractionArchive::getU32(const std::string& in, size_t& pos) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(in[pos++])) << (8 * i);
+    return value;
+}
+
+std::string InteractionArchive::getString(const std::string& in, size_t& pos) {
+    uint32_t length = getU32(in, pos);
+    std::string value = in.substr(pos, length);
+    pos += length;
+    return value;
+}
+
+bool InteractionArchive::open(const std::string& segmentPath) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (file.is_open())
+        return false;
+    path = segmentPath;
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    endOffset = 0;
+    return file.is_open();
+}
+
+bool InteractionArchive::append(const Interaction& interaction, uint64_t& offset) {
+    std::string record;
+    uint32_t kind = 0;
+    std::string extra;
+    if (auto email = dynamic_cast<const Email*>(&interaction)) {
+        kind = 1;
+        extra = email->getSubject();
+    } else if (auto meeting = dynamic_cast<const Meeting*>(&interaction)) {
+        kind = 2;
+        extra = meeting->getLocation();
+    }
+    uint64_t timestamp = static_cast<uint64_t>(interaction.getTimestamp());
+    putU32(record, kind);
+    putU32(record, static_cast<uint32_t>(timestamp));
+    putU32(record, static_cast<uint32_t>(timestamp >> 32));
+    putU32(record, static_cast<uint32_t>(interaction.getDuration()));
+    putString(record, interaction.getContent());
+    putString(record, extra);
+    
+    std::string framed;
+    putU32(framed, static_cast<uint32_t>(record.size()));
+    framed += record;
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    file.seekp(static_cast<std::streamoff>(endOffset));
+    if (!file.write(framed.data(), static_cast<std::streamsize>(framed.size()))) {
+        file.clear();
+        return false;
+    }
+    offset = endOffset;
+    endOffset += framed.size();
+    return true;
+}
+
+bool InteractionArchive::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!file.flush()) {
+        file.clear();
+        return false;
+    }
+    return true;
+}
+
+void InteractionArchive::truncate(uint64_t offset) {
+    std::lock_guard<std::mutex> lock(mutex);
+    endOffset = std::min(endOffset, offset);
+}
+
+std::unique_ptr<Interaction> InteractionArchive::read(uint64_t offset) {
+    std::string header(4, '\0');
+    std::string record;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        file.flush();
+        file.seekg(static_cast<std::streamoff>(offset));
+        if (!file.read(&header[0], 4)) {
+            file.clear();
+            return nullptr;
+        }
+        size_t pos = 0;
+        record.resize(getU32(header, pos));
+        if (!file.read(&record[0], static_cast<std::streamsize>(record.size()))) {
+            file.clear();
+            return nullptr;
+        }
+    }
+    
+    size_t pos = 0;
+    uint32_t kind = getU32(record, pos);
+    uint64_t low = getU32(record, pos);
+    uint64_t high = getU32(record, pos);
+    time_t timestamp = static_cast<time_t>(low | (high << 32));
+    int duration = static_cast<int>(getU32(record, pos));
+    std::string content = getString(record, pos);
+    std::string extra = getString(record, pos);
+    
+    switch (kind) {
+        case 1: return std::make_unique<Email>(content, extra, timestamp);
+        case 2: return std::make_unique<Meeting>(content, extra, duration, timestamp);
+        default: return std::make_unique<Call>(content, duration, timestamp);
+    }
+}
@@ -0,0 +1,262 @@
+// Full-text index over interaction content
+// interaction_index.cpp
+
+#include "crm/interaction_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <map>
+
+#include "crm/memory_usage.h"
+
+void InteractionIndex::writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t InteractionIndex::readVarint(const std::vector<uint8_t>& in, size_t& pos) {
+    uint32_t value = 0;
+    int shift = 0;
+    while (in[pos] & 0x80) {
+        value |= static_cast<uint32_t>(in[pos++] & 0x7F) << shift;
+        shift += 7;
+    }
+    value |= static_cast<uint32_t>(in[pos++]) << shift;
+    return value;
+}
+
+void InteractionIndex::skipVarints(const std::vector<uint8_t>& in, size_t& pos, uint32_t count) {
+    while (count > 0) {
+        if (!(in[pos++] & 0x80))
+            count--;
+    }
+}
+
+InteractionIndex::Cursor::Cursor(const PostingList* list) : list(list) {
+    next();
+}
+
+void InteractionIndex::Cursor::seekBlock(size_t block) {
+    pos = list->skips[block].offset;
+    doc = block == 0 ? 0 : list->skips[block - 1].lastDoc;
+    ordinal = static_cast<uint32_t>(block) * kBlockSize;
+    freq = 0;
+}
+
+bool InteractionIndex::Cursor::next() {
+    if (!list || ordinal == list->docCount) {
+        atEnd = true;
+        return false;
+    }
+    skipVarints(list->bytes, pos, freq);
+    doc += readVarint(list->bytes, pos);
+    freq = readVarint(list->bytes, pos);
+    positionsPos = pos;
+    ordinal++;
+    return true;
+}
+
+bool InteractionIndex::Cursor::advanceTo(uint32_t target) {
+    if (atEnd)
+        return false;
+    if (doc >= target)
+        return true;
+    size_t block = (ordinal - 1) / kBlockSize;
+    if (list->skips[block].lastDoc < target) {
+        auto skip = std::lower_bound(list->skips.begin() + block + 1, list->skips.end(), target,
+            [](const Skip& entry, uint32_t value) { return entry.lastDoc < value; });
+        if (skip == list->skips.end()) {
+            atEnd = true;
+            return false;
+        }
+        seekBlock(static_cast<size_t>(skip - list->skips.begin()));
+    }
+    while (doc < target) {
+        if (!next())
+            return false;
+    }
+    return true;
+}
+
+void InteractionIndex::Cursor::positions(std::vector<uint32_t>& out) const {
+    out.clear();
+    size_t at = positionsPos;
+    uint32_t position = 0;
+    for (uint32_t i = 0; i < freq; ++i) {
+        position += readVarint(list->bytes, at);
+        out.push_back(position);
+    }
+}
+
+std::vector<uint32_t> InteractionIndex::clauseDocs(const std::vector<std::vector<std::string>>& items) const {
+    std::vector<Cursor> cursors;
+    std::vector<size_t> itemStarts;  // first cursor of each item
+    for (const auto& terms : items) {
+        itemStarts.push_back(cursors.size());
+        for (const auto& term : terms) {
+            auto it = postings.find(term);
+            if (it == postings.end())
+                return {};
+            cursors.emplace_back(&it->second);
+        }
+    }
+    itemStarts.push_back(cursors.size());
+    
+    // The rarest list drives the walk; the others jump ahead to its documents
+    std::vector<size_t> order(cursors.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&cursors](size_t a, size_t b) { 
+        return cursors[a].size() < cursors[b].size(); 
+    });
+    
+    std::vector<uint32_t> docs;
+    std::vector<uint32_t> first;
+    std::vector<uint32_t> other;
+    uint32_t target = 0;
+    for (;;) {
+        bool aligned = true;
+        for (size_t i : order) {
+            if (!cursors[i].advanceTo(target))
+                return docs;
+            if (cursors[i].doc > target) {
+                target = cursors[i].doc;
+                aligned = false;
+                break;
+            }
+        }
+        if (!aligned)
+            continue;
+        
+        // Every term is in the document; check each phrase's terms are consecutive
+        bool match = true;
+        for (size_t item = 0; item + 1 < itemStarts.size() && match; ++item) {
+            size_t begin = itemStarts[item];
+            size_t end = itemStarts[item + 1];
+            if (end - begin < 2)
+                continue;
+            cursors[begin].positions(first);
+            for (size_t i = begin + 1; i < end && !first.empty(); ++i) {
+                cursors[i].positions(other);
+                uint32_t offset = static_cast<uint32_t>(i - begin);
+                first.erase(std::remove_if(first.begin(), first.end(), [&other, offset](uint32_t start) {
+                    return !std::binary_search(other.begin(), other.end(), start + offset);
+                }), first.end());
+            }
+            match = !first.empty();
+        }
+        if (match)
+            docs.push_back(target);
+        if (target == UINT32_MAX)
+            return docs;
+        target++;
+    }
+}
+
+std::vector<uint32_t> InteractionIndex::unite(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    std::vector<uint32_t> result;
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+    return result;
+}
+
+std::vector<std::string> InteractionIndex::tokenize(const std::string& text) {
+    std::vector<std::string> terms;
+    std::string current;
+    for (char ch : text) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        if (std::isalnum(c)) {
+            current += static_cast<char>(std::tolower(c));
+        } else if (!current.empty()) {
+            terms.push_back(current);
+            current.clear();
+        }
+    }
+    if (!current.empty())
+        terms.push_back(current);
+    return terms;
+}
+
+void InteractionIndex::addInteraction(int customerId, size_t interactionIndex, const std::string& text) {
+    uint32_t doc = static_cast<uint32_t>(documents.size());
+    documents.push_back({customerId, interactionIndex});
+    
+    std::map<std::string, std::vector<uint32_t>> termPositions;
+    auto terms = tokenize(text);
+    for (size_t i = 0; i < terms.size(); ++i)
+        termPositions[terms[i]].push_back(static_cast<uint32_t>(i));
+    
+    for (const auto& entry : termPositions) {
+        PostingList& list = postings[entry.first];
+        if (list.docCount % kBlockSize == 0)
+            list.skips.push_back({doc, static_cast<uint32_t>(list.bytes.size())});
+        list.skips.back().lastDoc = doc;
+        writeVarint(list.bytes, list.docCount == 0 ? doc : doc - list.lastDoc);
+        writeVarint(list.bytes, static_cast<uint32_t>(entry.second.size()));
+        uint32_t previous = 0;
+        for (uint32_t position : entry.second) {
+            writeVarint(list.bytes, position - previous);
+            previous = position;
+        }
+        list.lastDoc = doc;
+        list.docCount++;
+    }
+}
+
+std::vector<InteractionIndex::Hit> InteractionIndex::search(const std::string& query) const {
+    std::vector<uint32_t> result;
+    std::vector<std::vector<std::string>> clause;
+    
+    auto addItem = [&](std::vector<std::string> terms) {
+        if (!terms.empty())
+            clause.push_back(std::move(terms));
+    };
+    auto endClause = [&]() {
+        if (!clause.empty())
+            result = unite(result, clauseDocs(clause));
+        clause.clear();
+    };
+    
+    size_t pos = 0;
+    while (pos < query.size()) {
+        if (std::isspace(static_cast<unsigned char>(query[pos]))) {
+            ++pos;
+        } else if (query[pos] == '"') {
+            size_t end = query.find('"', pos + 1);
+            if (end == std::string::npos)
+                end = query.size();
+            addItem(tokenize(query.substr(pos + 1, end - pos - 1)));
+            pos = end + 1;
+        } else {
+            size_t end = pos;
+            while (end < query.size() && !std::isspace(static_cast<unsigned char>(query[end])) 
+                   && query[end] != '"')
+                ++end;
+            std::string word = query.substr(pos, end - pos);
+            if (word == "OR")
+                endClause();
+            else
+                addItem(tokenize(word));
+            pos = end;
+        }
+    }
+    endClause();
+    
+    std::vector<Hit> hits;
+    hits.reserve(result.size());
+    for (uint32_t doc : result) {
+        if (removedCustomers.empty() || !removedCustomers.count(documents[doc].customerId))
+            hits.push_back(documents[doc]);
+    }
+    return hits;
+}
+
+size_t InteractionIndex::getMemoryUsage() const {
+    size_t bytes = hashTableMemory(postings) + vectorMemory(documents) + hashTableMemory(removedCustomers);
+    for (const auto& entry : postings)
+        bytes += stringMemory(entry.first) + vectorMemory(entry.second.bytes) + vectorMemory(entry.second.skips);
+    return bytes;
+}
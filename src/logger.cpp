@@ -0,0 +1,152 @@
+// Logger used for side-effect messages of CRM operations
+// logger.cpp
+
+#include "crm/logger.h"
+
+#include <chrono>
+#include <cstring>
+
+bool Logger::tryPush(const std::string& message) {
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = ring[pos & (kCapacity - 1)];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.length = static_cast<uint16_t>(message.size());
+                std::memcpy(slot.text, message.data(), slot.length);
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+size_t Logger::drainLocked() {
+    size_t count = 0;
+    for (;;) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Slot& slot = ring[pos & (kCapacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+            break;
+        out->write(slot.text, slot.length);
+        out->put('\n');
+        slot.sequence.store(pos + kCapacity, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_release);
+        count++;
+    }
+    if (count)
+        out->flush();
+    return count;
+}
+
+size_t Logger::drain() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return drainLocked();
+}
+
+void Logger::run() {
+    while (running.load(std::memory_order_acquire)) {
+        if (drain() == 0)
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    drain();
+}
+
+Logger::Logger() : ring(new Slot[kCapacity]) {
+    for (size_t i = 0; i < kCapacity; ++i)
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+void Logger::setOutput(std::ostream& stream) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    out = &stream;
+}
+
+void Logger::startAsync() {
+    if (running.exchange(true))
+        return;
+    worker = std::thread(&Logger::run, this);
+    asyncMode.store(true, std::memory_order_release);
+}
+
+void Logger::stopAsync() {
+    if (!running.load())
+        return;
+    // Producers that saw async mode still on finish their push before the
+    // worker's final drain; later ones write directly
+    asyncMode.store(false);
+    while (inFlight.load() != 0)
+        std::this_thread::yield();
+    running.store(false, std::memory_order_release);
+    worker.join();
+}
+
+void Logger::flush() {
+    size_t target = enqueuePos.load(std::memory_order_acquire);
+    while (asyncMode.load(std::memory_order_acquire) && 
+           dequeuePos.load(std::memory_order_acquire) < target)
+        std::this_thread::yield();
+}
+
+void Logger::log(LogLevel messageLevel, const std::string& message) {
+    if (!isEnabled(messageLevel))
+        return;
+    if (message.size() <= kMaxMessage) {
+        // Sequentially consistent with stopAsync(), which clears asyncMode and
+        // then waits for inFlight to reach zero
+        inFlight.fetch_add(1);
+        if (asyncMode.load()) {
+            if (!tryPush(message))
+                dropped.fetch_add(1, std::memory_order_relaxed);
+            inFlight.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        inFlight.fetch_sub(1, std::memory_order_release);
+    }
+    // Write anything still queued first so this thread's messages stay in order
+    std::lock_guard<std::mutex> lock(writeMutex);
+    drainLocked();
+    *out << message << std::endl;
+}
+
+LogBuffer::LogBuffer() : std::ostream(this) {
+    text.reserve(256);
+}
+
+LogBuffer& LogBuffer::local() {
+    static thread_local LogBuffer buffer;
+    return buffer;
+}
+
+std::ostream& LogBuffer::start() {
+    text.clear();
+    clear();
+    flags(std::ios_base::dec | std::ios_base::skipws);
+    precision(6);
+    width(0);
+    fill(' ');
+    return *this;
+}
+
+std::streambuf::int_type LogBuffer::overflow(std::streambuf::int_type ch) {
+    using Traits = std::streambuf::traits_type;
+    if (!Traits::eq_int_type(ch, Traits::eof()))
+        text.push_back(Traits::to_char_type(ch));
+    return Traits::not_eof(ch);
+}
+
+std::streamsize LogBuffer::xsputn(const char* data, std::streamsize count) {
+    text.append(data, static_cast<size_t>(count));
+    return count;
+}
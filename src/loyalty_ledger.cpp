@@ -0,0 +1,49 @@
+// Batched ledger of VIP loyalty accruals
+// loyalty_ledger.cpp
+
+#include "crm/loyalty_ledger.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "crm/memory_usage.h"
+
+void LoyaltyLedger::accrue(int customerId, double points, LoyaltyReason reason, time_t timestamp) {
+    pending.push_back({customerId, reason, toFixed(points), timestamp});
+    if (pending.size() >= batchSize)
+        commit();
+}
+
+void LoyaltyLedger::commit() {
+    if (pending.empty())
+        return;
+    std::unordered_map<int, int64_t> deltas;
+    for (const Entry& entry : pending)
+        deltas[entry.customerId] += entry.amount;
+    entries.insert(entries.end(), pending.begin(), pending.end());
+    pending.clear();
+    
+    for (const auto& delta : deltas) {
+        balances[delta.first] += delta.second;
+        if (onCommit)
+            onCommit(delta.first, fromFixed(delta.second));
+    }
+}
+
+double LoyaltyLedger::getBalance(int customerId) const {
+    auto it = balances.find(customerId);
+    return it != balances.end() ? fromFixed(it->second) : 0.0;
+}
+
+std::vector<LoyaltyLedger::Entry> LoyaltyLedger::getHistory(int customerId) const {
+    std::vector<Entry> history;
+    for (const Entry& entry : entries) {
+        if (entry.customerId == customerId)
+            history.push_back(entry);
+    }
+    return history;
+}
+
+size_t LoyaltyLedger::getMemoryUsage() const {
+    return vectorMemory(entries) + vectorMemory(pending) + hashTableMemory(balances);
+}
@@ -0,0 +1,147 @@
+// CRM System Implementation
+// main.cpp
+
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#include "crm/crm.h"
+
+#if defined(CRM_HAS_ADMIN_SERVER)
+#include <csignal>
+
+#include "crm/admin_server.h"
+
+// Serve admin commands for the demo CRM until SIGINT or SIGTERM
+static int serveAdmin(CRM& crm, const std::string& socketPath) {
+    // Block the signals before the admin thread starts so only sigwait sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    
+    std::mutex crmMutex;
+    AdminServer server(crm, crmMutex);
+    if (!server.start(socketPath)) {
+        std::cerr << "Could not start admin server on " << socketPath << std::endl;
+        return 1;
+    }
+    std::cout << "Admin server listening on " << socketPath << std::endl;
+    
+    int signal = 0;
+    sigwait(&signals, &signal);
+    server.stop();
+    return 0;
+}
+#endif
+
+// Main function to demonstrate the CRM system
+// Pass --admin PATH to keep serving admin commands on a Unix socket afterwards
+int main(int argc, char* argv[]) {
+    std::string adminPath;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--admin") == 0 && i + 1 < argc) {
+            adminPath = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--admin SOCKET_PATH]" << std::endl;
+            return 1;
+        }
+    }
+    
+    // Create a CRM system
+    CRM crm;
+    
+    // Create some customers
+    auto regularCustomer = crm.createRegularCustomer(
+        "John Doe", "john@example.com", "555-1234", "Small Business");
+    
+    auto vipCustomer = crm.createVIPCustomer(
+        "Jane Smith", "jane@example.com", "555-5678", "Michael Johnson");
+    
+    auto corporateCustomer = crm.createCorporateCustomer(
+        "Bob Anderson", "bob@megacorp.com", "555-9876", "MegaCorp", 
+        1500, 50000.00);
+    
+    // Create sales representatives
+    auto salesRep1 = crm.createSalesRepresentative("Alice Thompson");
+    auto salesRep2 = crm.createSalesRepresentative("David Wilson");
+    
+    // Assign customers to sales representatives
+    crm.assignCustomerToRep(regularCustomer->getId(), salesRep1->getId());
+    crm.assignCustomerToRep(vipCustomer->getId(), salesRep1->getId());
+    crm.assignCustomerToRep(corporateCustomer->getId(), salesRep2->getId());
+    
+    // Let the CRM pick the rep for a new customer based on workload
+    auto newCustomer = crm.createRegularCustomer(
+        "Carol White", "carol@example.com", "555-2468", "Retail");
+    crm.autoAssignCustomer(newCustomer->getId());
+    
+    // Display all customers and sales representatives
+    crm.displayAllCustomers();
+    crm.displayAllSalesReps();
+    
+    // Record some interactions
+    salesRep1->recordCall(regularCustomer->getId(), "Discussed new product features", 15);
+    salesRep1->recordEmail(vipCustomer->getId(), "Sending exclusive offer details", "VIP Exclusive Offer");
+    salesRep1->recordMeeting(vipCustomer->getId(), "Quarterly review meeting", "Headquarters", 60);
+    salesRep2->recordCall(corporateCustomer->getId(), "Technical support for recent installation", 30);
+    salesRep2->recordMeeting(corporateCustomer->getId(), "Contract renewal discussion", "Client's Office", 90);
+    
+    // Display customer interactions
+    std::cout << "\n--- Customer Interactions ---\n";
+    salesRep1->viewCustomerInteractions(regularCustomer->getId());
+    salesRep1->viewCustomerInteractions(vipCustomer->getId());
+    salesRep2->viewCustomerInteractions(corporateCustomer->getId());
+    
+    // Perform customer-specific actions
+    std::cout << "\n--- Customer-Specific Actions ---\n";
+    salesRep1->performCustomerActions();
+    salesRep2->performCustomerActions();
+    
+    // Corporate-specific action
+    corporateCustomer->renewContract(75000.00);
+    
+    // Materialize loyalty points accrued from the interactions above
+    crm.commitLoyaltyPoints();
+    std::cout << "Loyalty points for " << vipCustomer->getName() << ": " 
+              << vipCustomer->getLoyaltyPoints() << std::endl;
+    
+    // Generate interaction time reports
+    std::cout << "\n--- Interaction Time Reports ---\n";
+    salesRep1->generateInteractionTimeReport();
+    salesRep2->generateInteractionTimeReport();
+    
+    // Top customers by interaction time
+    std::cout << "\n--- Top Customers ---\n";
+    crm.displayTopCustomers(2);
+    
+    // Search interactions
+    std::cout << "\n--- Interaction Search ---\n";
+    crm.displaySearchResults("contract renewal");
+    crm.displaySearchResults("\"quarterly review\" OR headquarters");
+    
+    // Check for duplicates before creating another customer
+    std::cout << "\n--- Duplicate Check ---\n";
+    for (const auto& match : crm.findPossibleDuplicates("Jon Doe", "John@Example.com", "555 1234")) {
+        std::cout << "Possible duplicate of customer " << match.secondId 
+                  << " (similarity " << match.similarity 
+                  << (match.exactMatch ? ", exact contact match" : "") << ")" << std::endl;
+    }
+    
+    // Generate system-wide report
+    crm.generateSystemReport();
+    crm.generateRevenueReport();
+    
+    if (!adminPath.empty()) {
+#if defined(CRM_HAS_ADMIN_SERVER)
+        return serveAdmin(crm, adminPath);
+#else
+        std::cerr << "The admin server is not available on this platform" << std::endl;
+        return 1;
+#endif
+    }
+
+    return 0;
+}
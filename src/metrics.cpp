@@ -0,0 +1,194 @@
+// Per-operation latency histograms for the public CRM API
+// metrics.cpp
+
+#include "crm/metrics.h"
+
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+const char* const kOperationNames[] = {
+    "CRM::createRegularCustomer",
+    "CRM::createVIPCustomer",
+    "CRM::createCorporateCustomer",
+    "CRM::createSalesRepresentative",
+    "CRM::getCustomer",
+    "CRM::getSalesRepresentative",
+    "CRM::getCustomerAsOf",
+    "CRM::getCustomers",
+    "CRM::getSalesRepresentatives",
+    "CRM::assignCustomerToRep",
+    "CRM::autoAssignCustomer",
+    "CRM::decayRepWorkloads",
+    "CRM::rebalanceCustomers",
+    "CRM::removeSalesRepresentative",
+    "CRM::reassignCustomer",
+    "CRM::reassignCustomers",
+    "CRM::unassignCustomer",
+    "CRM::removeCustomer",
+    "CRM::displayAllCustomers",
+    "CRM::displayAllSalesReps",
+    "CRM::filterCustomers",
+    "CRM::getTotalLoyaltyPoints",
+    "CRM::compressInteractionsOlderThan",
+    "CRM::loadScoringRules",
+    "CRM::addLoyaltyPoints",
+    "CRM::commitLoyaltyPoints",
+    "CRM::getLoyaltyBalance",
+    "CRM::getLoyaltyHistory",
+    "CRM::renewContracts",
+    "CRM::getAnnualContractValue",
+    "CRM::generateRevenueReport",
+    "CRM::scheduleCampaign",
+    "CRM::enableInteractionTiering",
+    "CRM::spillInteractionsOlderThan",
+    "CRM::countCustomersBySegment",
+    "CRM::countCustomersByAccountManager",
+    "CRM::countMeetingsByLocation",
+    "CRM::searchInteractions",
+    "CRM::displaySearchResults",
+    "CRM::getTopCustomersByInteractionTime",
+    "CRM::displayTopCustomers",
+    "CRM::findDuplicateCustomers",
+    "CRM::findPossibleDuplicates",
+    "CRM::generateSystemReport",
+    "CRM::countCustomersByType",
+    "CRM::getMemoryUsage",
+    "CRM::getReportSummary",
+    "CRM::openReportSnapshot",
+    "CRM::generateInteractionTimeReports",
+    "CRM::recordInteractions",
+    "SalesRepresentative::addCustomer",
+    "SalesRepresentative::removeCustomer",
+    "SalesRepresentative::recordCall",
+    "SalesRepresentative::recordEmail",
+    "SalesRepresentative::recordMeeting",
+    "SalesRepresentative::recordInteractions",
+    "SalesRepresentative::performCustomerActions",
+    "SalesRepresentative::scheduleCustomerActions",
+    "SalesRepresentative::displayCustomers",
+    "SalesRepresentative::viewCustomerInteractions",
+    "SalesRepresentative::generateInteractionTimeReport",
+};
+
+static_assert(sizeof(kOperationNames) / sizeof(kOperationNames[0]) == static_cast<size_t>(Operation::Count),
+              "every Operation needs a name");
+
+}  // namespace
+
+const char* operationName(Operation operation) {
+    size_t index = static_cast<size_t>(operation);
+    return index < static_cast<size_t>(Operation::Count) ? kOperationNames[index] : "Unknown";
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    uint64_t count = 0;
+    for (const auto& bucket : buckets)
+        count += bucket.load(std::memory_order_relaxed);
+    return count;
+}
+
+uint64_t LatencyHistogram::getPercentile(double quantile) const {
+    uint64_t count = getCount();
+    if (count == 0)
+        return 0;
+    uint64_t target = static_cast<uint64_t>(quantile * count);
+    if (target >= count)
+        target = count - 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen > target) {
+            uint64_t upper = i + 1 < kBucketCount ? bucketLowerBound(i + 1) - 1 : getMax();
+            return std::min(upper, getMax());
+        }
+    }
+    return getMax();
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+Metrics::Metrics() : startTicks(now()), startTime(std::chrono::steady_clock::now()) {}
+
+double Metrics::nanosPerTick() const {
+#if defined(CRM_HAS_TSC)
+    // Calibrate the TSC against the steady clock over the process lifetime so far
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+    if (elapsed < std::chrono::milliseconds(10)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10) - elapsed);
+    }
+    uint64_t ticks = now() - startTicks;
+    double nanos = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - startTime).count());
+    return ticks ? nanos / static_cast<double>(ticks) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+Metrics::OperationStats Metrics::getStats(Operation operation) const {
+    const LatencyHistogram& histogram = histograms[static_cast<size_t>(operation)];
+    double scale = nanosPerTick();
+    OperationStats stats;
+    stats.count = histogram.getCount();
+    stats.mean = stats.count ? scale * static_cast<double>(histogram.getTotal()) / stats.count : 0.0;
+    stats.p50 = scale * static_cast<double>(histogram.getPercentile(0.50));
+    stats.p90 = scale * static_cast<double>(histogram.getPercentile(0.90));
+    stats.p99 = scale * static_cast<double>(histogram.getPercentile(0.99));
+    stats.p999 = scale * static_cast<double>(histogram.getPercentile(0.999));
+    stats.max = scale * static_cast<double>(histogram.getMax());
+    return stats;
+}
+
+std::string Metrics::toText() const {
+    std::ostringstream out;
+    out << std::left << std::setw(50) << "operation" << std::right
+        << std::setw(10) << "count" << std::setw(12) << "mean ns" << std::setw(12) << "p50 ns"
+        << std::setw(12) << "p90 ns" << std::setw(12) << "p99 ns" << std::setw(12) << "p99.9 ns"
+        << std::setw(12) << "max ns" << "\n";
+    out << std::fixed << std::setprecision(0);
+    for (size_t i = 0; i < histograms.size(); ++i) {
+        Operation operation = static_cast<Operation>(i);
+        OperationStats stats = getStats(operation);
+        if (stats.count == 0)
+            continue;
+        out << std::left << std::setw(50) << operationName(operation) << std::right
+            << std::setw(10) << stats.count << std::setw(12) << stats.mean << std::setw(12) << stats.p50
+            << std::setw(12) << stats.p90 << std::setw(12) << stats.p99 << std::setw(12) << stats.p999
+            << std::setw(12) << stats.max << "\n";
+    }
+    return out.str();
+}
+
+std::string Metrics::toJson() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << "{\"operations\": [";
+    bool first = true;
+    for (size_t i = 0; i < histograms.size(); ++i) {
+        Operation operation = static_cast<Operation>(i);
+        OperationStats stats = getStats(operation);
+        if (stats.count == 0)
+            continue;
+        out << (first ? "" : ", ") << "{\"name\": \"" << operationName(operation) << "\""
+            << ", \"count\": " << stats.count << ", \"mean_ns\": " << stats.mean
+            << ", \"p50_ns\": " << stats.p50 << ", \"p90_ns\": " << stats.p90
+            << ", \"p99_ns\": " << stats.p99 << ", \"p999_ns\": " << stats.p999
+            << ", \"max_ns\": " << stats.max << "}";
+        first = false;
+    }
+    out << "]}";
+    return out.str();
+}
+
+void Metrics::reset() {
+    for (auto& histogram : histograms)
+        histogram.reset();
+}
@@ -0,0 +1,33 @@
+// Sales rep workload tracking for customer assignment
+// rep_load_balancer.cpp
+
+#include "crm/rep_load_balancer.h"
+
+void RepLoadBalancer::addRep(int repId) {
+    if (loads.emplace(repId, Load()).second) {
+        byLoad.insert({0.0, repId});
+        byCustomers.insert({0, repId});
+    }
+}
+
+void RepLoadBalancer::removeRep(int repId) {
+    auto it = loads.find(repId);
+    if (it == loads.end())
+        return;
+    byLoad.erase({score(it->second), repId});
+    byCustomers.erase({it->second.customers, repId});
+    loads.erase(it);
+}
+
+void RepLoadBalancer::decayRecentMinutes(double factor) {
+    byLoad.clear();
+    for (auto& entry : loads) {
+        entry.second.recentMinutes *= factor;
+        byLoad.insert({score(entry.second), entry.first});
+    }
+}
+
+double RepLoadBalancer::getLoad(int repId) const {
+    auto it = loads.find(repId);
+    return it != loads.end() ? score(it->second) : 0.0;
+}
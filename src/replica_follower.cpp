@@ -0,0 +1,196 @@
+// Read replica that follows a primary CrmServer
+// replica_follower.cpp
+
+#include "crm/replica_follower.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include "crm/logger.h"
+
+namespace {
+
+int connectTo(const std::string& host, uint16_t port) {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1)
+        return -1;
+    
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Write the whole buffer, retrying on short writes
+bool writeAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        written += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+}  // namespace
+
+bool ReplicaFollower::start(const std::string& primaryHost, uint16_t primaryPort) {
+    if (worker.joinable())
+        return false;
+    in_addr ignored;
+    if (::inet_pton(AF_INET, primaryHost.c_str(), &ignored) != 1) {
+        CRM_LOG(LogLevel::Warning, "Invalid primary address: " << primaryHost);
+        return false;
+    }
+    host = primaryHost;
+    port = primaryPort;
+    running = true;
+    worker = std::thread(&ReplicaFollower::run, this);
+    return true;
+}
+
+void ReplicaFollower::stop() {
+    running = false;
+    if (worker.joinable())
+        worker.join();
+}
+
+void ReplicaFollower::run() {
+    while (running) {
+        int fd = connectTo(host, port);
+        if (fd >= 0) {
+            bool canContinue = follow(fd);
+            ::close(fd);
+            if (!canContinue) {
+                running = false;
+                return;
+            }
+            CRM_LOG(LogLevel::Warning, "Lost connection to primary " << host << ":" << port << ", reconnecting");
+        }
+        
+        auto retryAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(kRetryMillis);
+        while (running && std::chrono::steady_clock::now() < retryAt)
+            std::this_thread::sleep_for(std::chrono::milliseconds(kPollMillis));
+    }
+}
+
+bool ReplicaFollower::follow(int fd) {
+    ServiceRequest subscribe;
+    subscribe.op = ServiceOp::Subscribe;
+    subscribe.sequence = nextSequence;
+    std::string frame;
+    encodeServiceRequest(subscribe, frame);
+    if (!writeAll(fd, frame))
+        return true;
+    
+    bool subscribed = false;
+    uint32_t snapshotFrames = 0;  // still to come before the log entries
+    uint64_t snapshotSequence = 0;
+    
+    // Every way out goes through here. Once part of a snapshot has been applied
+    // the replica cannot resume: reconnecting would load a fresh snapshot on
+    // top of it and duplicate customers and reps.
+    bool partialSnapshot = false;
+    auto leave = [&partialSnapshot]() {
+        if (!partialSnapshot)
+            return true;
+        CRM_LOG(LogLevel::Warning, "Connection to primary dropped while loading the snapshot");
+        return false;
+    };
+    std::string input;
+    char buffer[64 * 1024];
+    while (running) {
+        pollfd entry{fd, POLLIN, 0};
+        int ready = ::poll(&entry, 1, kPollMillis);
+        if (ready <= 0)
+            continue;
+        ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        input.append(buffer, static_cast<size_t>(n));
+        
+        size_t consumed = 0;
+        size_t logFrames = 0;
+        batch.batch.clear();
+        while (true) {
+            size_t size = serviceFrameSize(input.data() + consumed, input.size() - consumed);
+            if (size == SIZE_MAX) {
+                CRM_LOG(LogLevel::Warning, "Primary sent an oversized frame");
+                return leave();
+            }
+            if (size == 0)
+                break;
+            const char* payload = input.data() + consumed + 4;
+            consumed += size;
+            
+            if (!subscribed) {
+                ServiceResponse response;
+                if (!decodeServiceResponse(payload, size - 4, response) || response.op != ServiceOp::Subscribe)
+                    return leave();
+                if (response.status != ServiceStatus::Ok) {
+                    CRM_LOG(LogLevel::Warning, "Primary cannot resume replication from sequence " << nextSequence 
+                            << "; the replica must be rebuilt from a snapshot");
+                    return false;
+                }
+                subscribed = true;
+                if (nextSequence == 0) {
+                    snapshotFrames = response.value;
+                    snapshotSequence = response.sequence;
+                }
+                continue;
+            }
+            
+            batch.batch.emplace_back();
+            if (!decodeServiceRequest(payload, size - 4, batch.batch.back())) {
+                CRM_LOG(LogLevel::Warning, "Primary sent a malformed request frame");
+                return leave();
+            }
+            if (snapshotFrames > 0)
+                snapshotFrames--;
+            else
+                logFrames++;
+        }
+        input.erase(0, consumed);
+        
+        if (!batch.batch.empty() && !applyBatch())
+            CRM_LOG(LogLevel::Warning, "Replicated requests failed; the replica may have diverged from the primary");
+        if (batch.batch.size() > logFrames)
+            partialSnapshot = snapshotFrames > 0;
+        if (subscribed && snapshotFrames == 0) {
+            if (nextSequence == 0)
+                nextSequence = snapshotSequence;
+            nextSequence += logFrames;
+        }
+    }
+    return leave();
+}
+
+bool ReplicaFollower::applyBatch() {
+    batch.op = ServiceOp::Batch;
+    {
+        std::lock_guard<std::mutex> lock(crmMutex);
+        service.execute(batch, batchResponse);
+    }
+    for (const auto& response : batchResponse.batch)
+        if (response.status != ServiceStatus::Ok)
+            return false;
+    return true;
+}
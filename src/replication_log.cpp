@@ -0,0 +1,39 @@
+// Mutation log shipped from a primary CRM to its read replicas
+// replication_log.cpp
+
+#include "crm/replication_log.h"
+
+#include <algorithm>
+
+void ReplicationLog::append(const ServiceRequest& request) {
+    offsets.push_back(frames.size());
+    encodeServiceRequest(request, frames);
+    if (frames.size() > capacity)
+        trim();
+}
+
+void ReplicationLog::trim() {
+    size_t dropped = 0;
+    while (!offsets.empty() && frames.size() - dropped > capacity / 2) {
+        offsets.pop_front();
+        firstSequence++;
+        dropped = offsets.empty() ? frames.size() : offsets.front();
+    }
+    frames.erase(0, dropped);
+    for (size_t& offset : offsets)
+        offset -= dropped;
+}
+
+uint64_t ReplicationLog::copyFrom(uint64_t sequence, std::string& out, size_t maxBytes) const {
+    if (sequence >= getNextSequence())
+        return getNextSequence();
+    
+    // Take every frame that starts within maxBytes of the first one
+    size_t index = static_cast<size_t>(sequence - firstSequence);
+    size_t begin = offsets[index];
+    auto last = maxBytes >= frames.size() - begin ? offsets.end() : 
+                std::upper_bound(offsets.begin() + index + 1, offsets.end(), begin + maxBytes);
+    size_t end = last == offsets.end() ? frames.size() : *last;
+    out.append(frames, begin, end - begin);
+    return firstSequence + static_cast<uint64_t>(last - offsets.begin());
+}
@@ -0,0 +1,83 @@
+// Mergeable aggregates behind the system-wide reports
+// report_summary.cpp
+
+#include "crm/report_summary.h"
+
+#include <algorithm>
+
+void ReportSummary::merge(const ReportSummary& other, size_t topK) {
+    for (int kind = 0; kind < 3; ++kind)
+        customersByKind[kind] += other.customersByKind[kind];
+    interactionMinutes += other.interactionMinutes;
+    contractCents += other.contractCents;
+    
+    if (reps.empty()) {
+        reps = other.reps;
+    } else {
+        for (size_t i = 0; i < reps.size() && i < other.reps.size(); ++i) {
+            reps[i].contractCents += other.reps[i].contractCents;
+            reps[i].customers.insert(reps[i].customers.end(), other.reps[i].customers.begin(), 
+                                     other.reps[i].customers.end());
+        }
+    }
+    
+    std::vector<CustomerTotals> merged;
+    merged.reserve(std::min(topK, top.size() + other.top.size()));
+    auto better = [](const CustomerTotals& a, const CustomerTotals& b) {
+        return a.minutes != b.minutes ? a.minutes > b.minutes : a.id < b.id;
+    };
+    auto left = top.begin();
+    auto right = other.top.begin();
+    while (merged.size() < topK && (left != top.end() || right != other.top.end())) {
+        if (right == other.top.end() || (left != top.end() && better(*left, *right)))
+            merged.push_back(std::move(*left++));
+        else
+            merged.push_back(*right++);
+    }
+    top = std::move(merged);
+}
+
+void ReportSummary::writeSystemReport(std::ostream& out) const {
+    out << "\n========== CRM SYSTEM REPORT ==========\n";
+    out << "Total Customers: " << customersByKind[0] + customersByKind[1] + customersByKind[2] << std::endl;
+    
+    // Type names in alphabetical order, as CRM::countCustomersByType lists them
+    const CustomerKind kinds[] = {CustomerKind::Corporate, CustomerKind::Regular, CustomerKind::VIP};
+    for (CustomerKind kind : kinds) {
+        if (uint32_t count = customersByKind[static_cast<int>(kind)])
+            out << "  " << customerKindName(kind) << " Customers: " << count << std::endl;
+    }
+    
+    out << "Total Sales Representatives: " << reps.size() << std::endl;
+    out << "Total Interaction Time: " << interactionMinutes << " minutes" << std::endl;
+    out << "======================================\n";
+}
+
+void ReportSummary::writeRevenueReport(std::ostream& out) const {
+    out << "\n========== REVENUE REPORT ==========\n";
+    for (const RepTotals& rep : reps)
+        out << rep.name << ": $" << static_cast<double>(rep.contractCents) / 100 << std::endl;
+    out << "Total Annual Contract Value: $" << static_cast<double>(contractCents) / 100 << std::endl;
+    out << "====================================\n";
+}
+
+void ReportSummary::writeInteractionTimeReports(std::ostream& out) const {
+    for (const RepTotals& rep : reps) {
+        out << "\nInteraction Time Report for Sales Rep: " << rep.name << "\n";
+        out << "----------------------------------------\n";
+        for (const CustomerTotals& customer : rep.customers) {
+            out << "Customer: " << customer.name << " (" << customerKindName(customer.kind) << ")"
+                << " - Total Interaction Time: " << customer.minutes << " minutes\n";
+        }
+        out << "----------------------------------------\n";
+    }
+}
+
+void ReportSummary::writeTopCustomers(size_t k, std::ostream& out) const {
+    out << "Top " << k << " Customers by Interaction Time:" << std::endl;
+    int rank = 1;
+    for (size_t i = 0; i < top.size() && i < k; ++i) {
+        out << rank++ << ". " << top[i].name << " (" << customerKindName(top[i].kind) << ") - " 
+            << top[i].minutes << " minutes" << std::endl;
+    }
+}
@@ -0,0 +1,212 @@
+// Multi-version copy of the report fields for lock-free report snapshots
+// report_versions.cpp
+
+#include "crm/report_versions.h"
+
+#include <algorithm>
+
+#include "crm/memory_usage.h"
+
+ReportVersions::Chunk& ReportVersions::writableChunk(size_t index) {
+    std::unique_ptr<Chunk>& chunk = chunks[index];
+    
+    // Snapshots opened since the chunk was created may be reading it
+    if (chunk->epoch <= newestPinned.load(std::memory_order_acquire)) {
+        auto copy = std::make_unique<Chunk>(Chunk{currentEpoch, chunk->rows});
+        copy->rows.reserve(kChunkRows);
+        std::lock_guard<std::mutex> lock(epochMutex);
+        retired.push_back({currentEpoch, std::move(chunk)});
+        chunk = std::move(copy);
+        reclaim();
+    }
+    return *chunk;
+}
+
+void ReportVersions::add(Row row) {
+    if (rowCount % kChunkRows == 0) {
+        chunks.push_back(std::make_unique<Chunk>());
+        chunks.back()->epoch = currentEpoch;
+        chunks.back()->rows.reserve(kChunkRows);
+    }
+    writableChunk(chunks.size() - 1).rows.push_back(std::move(row));
+    rowCount++;
+}
+
+void ReportVersions::remove(uint32_t row) {
+    if (row >= rowCount)
+        return;
+    Chunk& last = writableChunk(chunks.size() - 1);
+    if (row + 1 != rowCount)
+        writableRow(row) = std::move(last.rows.back());
+    last.rows.pop_back();
+    rowCount--;
+    if (last.rows.empty())
+        chunks.pop_back();
+}
+
+void ReportVersions::setRepId(uint32_t row, int repId, uint32_t repSlot) {
+    Row& target = writableRow(row);
+    target.repId = repId;
+    target.repSlot = repSlot;
+}
+
+void ReportVersions::setMinutes(uint32_t row, int minutes) {
+    // Unchanged values (e.g. emails, which take no time) need no new version
+    if (chunks[row / kChunkRows]->rows[row % kChunkRows].minutes != minutes)
+        writableRow(row).minutes = minutes;
+}
+
+void ReportVersions::setContractCents(uint32_t row, int64_t cents) {
+    if (chunks[row / kChunkRows]->rows[row % kChunkRows].contractCents != cents)
+        writableRow(row).contractCents = cents;
+}
+
+void ReportVersions::removeRep(int repId) {
+    reps.erase(std::remove_if(reps.begin(), reps.end(), 
+                              [repId](const auto& rep) { return rep.first == repId; }), reps.end());
+}
+
+ReportVersions::Snapshot ReportVersions::openSnapshot() {
+    Snapshot snapshot;
+    snapshot.versions = this;
+    snapshot.chunks.reserve(chunks.size());
+    for (const auto& chunk : chunks)
+        snapshot.chunks.push_back(chunk.get());
+    snapshot.reps = reps;
+    snapshot.rowCount = rowCount;
+    
+    // Later writes go to a new epoch, so they never touch what this snapshot sees
+    std::lock_guard<std::mutex> lock(epochMutex);
+    snapshot.epoch = currentEpoch++;
+    pinned.insert(snapshot.epoch);
+    newestPinned.store(snapshot.epoch, std::memory_order_release);
+    return snapshot;
+}
+
+void ReportVersions::release(uint64_t epoch) {
+    std::lock_guard<std::mutex> lock(epochMutex);
+    pinned.erase(pinned.find(epoch));
+    newestPinned.store(pinned.empty() ? 0 : *pinned.rbegin(), std::memory_order_release);
+    reclaim();
+}
+
+void ReportVersions::reclaim() {
+    // A retired chunk is visible to the snapshots pinned in [its epoch, the epoch it was replaced in)
+    retired.erase(std::remove_if(retired.begin(), retired.end(), [this](const Retired& entry) {
+        auto it = pinned.lower_bound(entry.chunk->epoch);
+        return it == pinned.end() || *it >= entry.replacedIn;
+    }), retired.end());
+}
+
+size_t ReportVersions::getOpenSnapshotCount() const {
+    std::lock_guard<std::mutex> lock(epochMutex);
+    return pinned.size();
+}
+
+size_t ReportVersions::getRetiredChunkCount() const {
+    std::lock_guard<std::mutex> lock(epochMutex);
+    return retired.size();
+}
+
+size_t ReportVersions::getMemoryUsage() const {
+    auto chunkMemory = [](const Chunk& chunk) {
+        size_t bytes = sizeof(Chunk) + vectorMemory(chunk.rows);
+        for (const Row& row : chunk.rows)
+            bytes += stringMemory(row.name);
+        return bytes;
+    };
+    size_t bytes = vectorMemory(chunks) + vectorMemory(reps);
+    for (const auto& chunk : chunks)
+        bytes += chunkMemory(*chunk);
+    for (const auto& rep : reps)
+        bytes += stringMemory(rep.second);
+    
+    std::lock_guard<std::mutex> lock(epochMutex);
+    for (const Retired& entry : retired)
+        bytes += chunkMemory(*entry.chunk);
+    return bytes;
+}
+
+ReportVersions::Snapshot& ReportVersions::Snapshot::operator=(Snapshot&& other) noexcept {
+    if (this != &other) {
+        release();
+        versions = other.versions;
+        epoch = other.epoch;
+        chunks = std::move(other.chunks);
+        reps = std::move(other.reps);
+        rowCount = other.rowCount;
+        other.versions = nullptr;
+        other.epoch = 0;
+        other.rowCount = 0;
+    }
+    return *this;
+}
+
+void ReportVersions::Snapshot::release() {
+    if (!versions)
+        return;
+    versions->release(epoch);
+    versions = nullptr;
+    chunks.clear();
+    reps.clear();
+    rowCount = 0;
+}
+
+ReportSummary ReportVersions::Snapshot::summarize(size_t topK, bool withRepCustomers) const {
+    ReportSummary summary;
+    std::vector<const Row*> top;
+    std::vector<std::vector<const Row*>> repRows(withRepCustomers ? reps.size() : 0);
+    auto better = [](const Row* a, const Row* b) {
+        return a->minutes != b->minutes ? a->minutes > b->minutes : a->id < b->id;
+    };
+    
+    summary.reps.resize(reps.size());
+    std::vector<std::pair<int, size_t>> repIndex;  // (rep id, position), sorted by id
+    for (size_t i = 0; i < reps.size(); ++i) {
+        summary.reps[i].name = reps[i].second;
+        repIndex.emplace_back(reps[i].first, i);
+    }
+    std::sort(repIndex.begin(), repIndex.end());
+    
+    for (const Chunk* chunk : chunks) {
+        for (const Row& row : chunk->rows) {
+            summary.customersByKind[static_cast<int>(row.kind)]++;
+            summary.interactionMinutes += row.minutes;
+            summary.contractCents += row.contractCents;
+            
+            auto rep = std::lower_bound(repIndex.begin(), repIndex.end(), std::make_pair(row.repId, size_t{0}));
+            if (row.repId != 0 && rep != repIndex.end() && rep->first == row.repId) {
+                ReportSummary::RepTotals& totals = summary.reps[rep->second];
+                totals.contractCents += row.contractCents;
+                if (withRepCustomers)
+                    repRows[rep->second].push_back(&row);
+            }
+            
+            // Keep the best topK rows as a heap whose front is the worst of them
+            if (topK == 0)
+                continue;
+            if (top.size() < topK) {
+                top.push_back(&row);
+                std::push_heap(top.begin(), top.end(), better);
+            } else if (better(&row, top.front())) {
+                std::pop_heap(top.begin(), top.end(), better);
+                top.back() = &row;
+                std::push_heap(top.begin(), top.end(), better);
+            }
+        }
+    }
+    
+    // Table order differs from portfolio order once customers move or are removed
+    for (size_t i = 0; i < repRows.size(); ++i) {
+        std::sort(repRows[i].begin(), repRows[i].end(),
+                  [](const Row* a, const Row* b) { return a->repSlot < b->repSlot; });
+        summary.reps[i].customers.reserve(repRows[i].size());
+        for (const Row* row : repRows[i])
+            summary.reps[i].customers.push_back({row->id, row->name, row->kind, row->minutes});
+    }
+    
+    std::sort_heap(top.begin(), top.end(), better);
+    for (const Row* row : top)
+        summary.top.push_back({row->id, row->name, row->kind, row->minutes});
+    return summary;
+}
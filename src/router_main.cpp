@@ -0,0 +1,95 @@
+// CRM shard router
+// router_main.cpp
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "crm/crm_server.h"
+#include "crm/logger.h"
+#include "crm/shard_router.h"
+
+static void printUsage(const char* program) {
+    std::cerr << "usage: " << program << " --shards ADDRESS:PORT,... [--host ADDRESS] [--port PORT]"
+              << " [--shard-timeout MS]\n"
+              << "  --shards ADDRESS:PORT,...  shard servers, shard i started with --shard i/N\n"
+              << "  --host ADDRESS             IPv4 address to listen on (default 127.0.0.1)\n"
+              << "  --port PORT                TCP port (default 7070, 0 picks a free one)\n"
+              << "  --shard-timeout MS         time a shard has to connect, accept or answer a request\n"
+              << "                             before its requests get Unavailable (default "
+              << ShardRouter::kDefaultTimeoutMs << ")\n";
+}
+
+// Parse "ADDRESS:PORT,ADDRESS:PORT,..."; false if any entry is malformed
+static bool parseShards(const std::string& list, std::vector<std::pair<std::string, uint16_t>>& shards) {
+    std::istringstream in(list);
+    std::string entry;
+    while (std::getline(in, entry, ',')) {
+        size_t colon = entry.rfind(':');
+        if (colon == std::string::npos)
+            return false;
+        unsigned long port = std::strtoul(entry.c_str() + colon + 1, nullptr, 10);
+        if (port == 0 || port > 65535)
+            return false;
+        shards.emplace_back(entry.substr(0, colon), static_cast<uint16_t>(port));
+    }
+    return !shards.empty();
+}
+
+int main(int argc, char* argv[]) {
+    std::string host = "127.0.0.1";
+    unsigned long port = 7070;
+    unsigned long timeoutMs = ShardRouter::kDefaultTimeoutMs;
+    std::vector<std::pair<std::string, uint16_t>> shards;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--host") host = value;
+        else if (arg == "--port" && (port = std::strtoul(value, nullptr, 10)) <= 65535) {}
+        else if (arg == "--shards" && parseShards(value, shards)) {}
+        else if (arg == "--shard-timeout" && (timeoutMs = std::strtoul(value, nullptr, 10)) > 0 && 
+                 timeoutMs <= 3600000) {}
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (shards.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    
+    Logger::instance().setLevel(LogLevel::Warning);
+    raiseDescriptorLimit();
+    
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    
+    // The router holds no CRM; the mutex only guards the router itself
+    ShardRouter router(shards, static_cast<int>(timeoutMs));
+    std::mutex routerMutex;
+    CrmServer server(router, routerMutex);
+    if (!server.start(host, static_cast<uint16_t>(port))) {
+        std::cerr << "Could not start router on " << host << ":" << port << std::endl;
+        return 1;
+    }
+    std::cout << "CRM router listening on " << host << ":" << server.getPort() 
+              << " for " << shards.size() << " shards" << std::endl;
+    
+    int signal = 0;
+    sigwait(&signals, &signal);
+    server.stop();
+    return 0;
+}
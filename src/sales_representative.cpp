@@ -0,0 +1,185 @@
+// SalesRepresentative class
+// sales_representative.cpp
+
+#include "crm/sales_representative.h"
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+#include "crm/interaction.h"
+#include "crm/logger.h"
+#include "crm/memory_usage.h"
+#include "crm/metrics.h"
+#include "crm/scoring_rules.h"
+
+Customer* SalesRepresentative::findCustomer(int customerId) {
+    auto it = positions.find(customerId);
+    if (it != positions.end())
+        return registry->get(customers[it->second]);
+        
+    return nullptr;
+}
+
+void SalesRepresentative::accrueLoyalty(Customer* customer, double points, LoyaltyReason reason) {
+    if (customer->getKind() != CustomerKind::VIP)
+        return;
+    if (ledger) {
+        ledger->accrue(customer->getId(), points, reason);
+        CRM_LOG(LogLevel::Info, "Accrued " << points << " loyalty points for " << customer->getName());
+    } else {
+        static_cast<VIPCustomer*>(customer)->addLoyaltyPoints(points);
+    }
+}
+
+void SalesRepresentative::addCustomer(CustomerHandle handle) {
+    OperationTimer timer(Operation::RepAddCustomer);
+    const Customer* customer = registry->get(handle);
+    if (!customer || positions.count(customer->getId()))
+        return;
+    positions[customer->getId()] = customers.size();
+    customers.push_back(handle);
+}
+
+CustomerHandle SalesRepresentative::removeCustomer(int customerId) {
+    OperationTimer timer(Operation::RepRemoveCustomer);
+    auto it = positions.find(customerId);
+    if (it == positions.end())
+        return CustomerHandle();
+    
+    size_t index = it->second;
+    positions.erase(it);
+    CustomerHandle handle = customers[index];
+    if (index + 1 != customers.size()) {
+        customers[index] = customers.back();
+        positions[registry->get(customers[index])->getId()] = index;
+    }
+    customers.pop_back();
+    return handle;
+}
+
+bool SalesRepresentative::addInteraction(int customerId, std::unique_ptr<Interaction> interaction, 
+                                         InteractionKind kind) {
+    auto customer = findCustomer(customerId);
+    if (!customer) {
+        CRM_LOG(LogLevel::Warning, "Customer not found.");
+        return false;
+    }
+    
+    int duration = interaction->getDuration();
+    customer->addInteraction(std::move(interaction));
+    
+    static const char* const kLabels[] = {"Call", "Email", "Meeting"};
+    CRM_LOG(LogLevel::Info, kLabels[static_cast<int>(kind)] << " recorded with " << customer->getName());
+    
+    // Add loyalty points for VIP customers
+    static const LoyaltyReason kReasons[] = {LoyaltyReason::Call, LoyaltyReason::Email, LoyaltyReason::Meeting};
+    accrueLoyalty(customer, rules->loyaltyPoints(kind, duration), 
+                  kReasons[static_cast<int>(kind)]);
+    return true;
+}
+
+bool SalesRepresentative::recordCall(int customerId, const std::string& content, int duration) {
+    OperationTimer timer(Operation::RecordCall);
+    return addInteraction(customerId, std::make_unique<Call>(content, duration), InteractionKind::Call);
+}
+
+bool SalesRepresentative::recordEmail(int customerId, const std::string& content, const std::string& subject) {
+    OperationTimer timer(Operation::RecordEmail);
+    return addInteraction(customerId, std::make_unique<Email>(content, subject), InteractionKind::Email);
+}
+
+bool SalesRepresentative::recordMeeting(int customerId, const std::string& content, 
+                                       const std::string& location, int duration) {
+    OperationTimer timer(Operation::RecordMeeting);
+    return addInteraction(customerId, std::make_unique<Meeting>(content, location, duration), InteractionKind::Meeting);
+}
+
+size_t SalesRepresentative::recordInteractions(const std::vector<InteractionRecord>& records, size_t begin, 
+                                               size_t end, std::vector<bool>& recorded) {
+    OperationTimer timer(Operation::RepRecordInteractions);
+    size_t count = 0;
+    for (size_t i = begin; i < end; ++i) {
+        const InteractionRecord& record = records[i];
+        std::unique_ptr<Interaction> interaction;
+        if (record.kind == InteractionKind::Call)
+            interaction = std::make_unique<Call>(record.content, record.duration);
+        else if (record.kind == InteractionKind::Email)
+            interaction = std::make_unique<Email>(record.content, record.detail);
+        else
+            interaction = std::make_unique<Meeting>(record.content, record.detail, record.duration);
+        recorded[i] = addInteraction(record.customerId, std::move(interaction), record.kind);
+        count += recorded[i];
+    }
+    return count;
+}
+
+void SalesRepresentative::performCustomerActions() {
+    OperationTimer timer(Operation::PerformCustomerActions);
+    for (CustomerHandle handle : customers) {
+        registry->get(handle)->performCustomerSpecificAction();
+    }
+}
+
+void SalesRepresentative::scheduleCustomerActions(CampaignScheduler& scheduler, std::ostream& out) const {
+    OperationTimer timer(Operation::ScheduleCustomerActions);
+    // Workers of every scheduler share one lock so actions never interleave
+    static std::mutex outputMutex;
+    for (CustomerHandle handle : customers) {
+        const Customer* customer = registry->get(handle);
+        CustomerKind kind = customer->getKind();
+        int priority = kind == CustomerKind::VIP ? 0 : kind == CustomerKind::Corporate ? 1 : 2;
+        std::ostringstream action;
+        customer->performCustomerSpecificAction(action);
+        scheduler.submit(priority, [&out, text = action.str()] {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            out << text << std::flush;
+        });
+    }
+}
+
+void SalesRepresentative::displayCustomers() const {
+    OperationTimer timer(Operation::DisplayCustomers);
+    if (customers.empty()) {
+        std::cout << "No customers assigned to " << name << std::endl;
+        return;
+    }
+    
+    std::cout << "Customers assigned to " << name << ":" << std::endl;
+    for (CustomerHandle handle : customers) {
+        const Customer* customer = registry->get(handle);
+        std::cout << "ID: " << customer->getId() 
+                  << ", Name: " << customer->getName()
+                  << ", Type: " << customer->getType() << std::endl;
+    }
+}
+
+void SalesRepresentative::viewCustomerInteractions(int customerId) {
+    OperationTimer timer(Operation::ViewCustomerInteractions);
+    auto customer = findCustomer(customerId);
+    if (customer) {
+        customer->displayInteractions();
+    } else {
+        std::cout << "Customer not found." << std::endl;
+    }
+}
+
+void SalesRepresentative::generateInteractionTimeReport(std::ostream& out) const {
+    OperationTimer timer(Operation::GenerateInteractionTimeReport);
+    out << "\nInteraction Time Report for Sales Rep: " << name << "\n";
+    out << "----------------------------------------\n";
+    
+    for (CustomerHandle handle : customers) {
+        const Customer* customer = registry->get(handle);
+        int totalTime = customer->calculateTotalInteractionTime();
+        out << "Customer: " << customer->getName() 
+                  << " (" << customer->getType() << ")"
+                  << " - Total Interaction Time: " << totalTime << " minutes\n";
+    }
+    out << "----------------------------------------\n";
+}
+
+size_t SalesRepresentative::getMemoryUsage() const {
+    return stringMemory(name) + vectorMemory(customers) + hashTableMemory(positions);
+}
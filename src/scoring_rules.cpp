@@ -0,0 +1,115 @@
+// Configurable loyalty and interaction-time scoring rules
+// scoring_rules.cpp
+
+#include "crm/scoring_rules.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+bool ScoringRules::interactionIndex(const std::string& name, int& index) {
+    static const char* names[] = {"call", "email", "meeting"};
+    for (int i = 0; i < 3; ++i) {
+        if (name == names[i]) {
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ScoringRules::customerIndex(const std::string& name, int& index) {
+    static const char* names[] = {"regular", "vip", "corporate"};
+    for (int i = 0; i < 3; ++i) {
+        if (name == names[i]) {
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const ScoringRules& ScoringRules::defaults() {
+    static const ScoringRules rules;
+    return rules;
+}
+
+double ScoringRules::loyaltyPoints(InteractionKind kind, int duration) const {
+    int index = static_cast<int>(kind);
+    return flatPoints[index] + pointsPerMinute[index] * duration;
+}
+
+double ScoringRules::multiplierFor(CustomerKind kind, int employees) const {
+    double multiplier = kindMultipliers[static_cast<int>(kind)];
+    if (kind == CustomerKind::Corporate) {
+        for (const CorporateTier& tier : corporateTiers) {
+            if (employees > tier.minEmployees)
+                multiplier = tier.multiplier;
+        }
+    }
+    return multiplier;
+}
+
+bool ScoringRules::parse(std::istream& in, std::string& error) {
+    bool tiersSeen = false;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        size_t equals = line.find('=');
+        std::istringstream keyStream(line.substr(0, equals));
+        std::string key;
+        if (!(keyStream >> key))
+            continue;
+        
+        std::istringstream valueStream(equals == std::string::npos ? "" : line.substr(equals + 1));
+        size_t dot = key.find('.');
+        std::string scope = key.substr(0, dot);
+        std::string field = dot == std::string::npos ? "" : key.substr(dot + 1);
+        int index;
+        double value;
+        bool ok = false;
+        
+        if (field == "tier" && scope == "corporate") {
+            int minEmployees;
+            if (valueStream >> minEmployees >> value) {
+                if (!tiersSeen)
+                    corporateTiers.clear();
+                tiersSeen = true;
+                corporateTiers.push_back({minEmployees, value});
+                ok = true;
+            }
+        } else if (valueStream >> value) {
+            if (field == "points" && interactionIndex(scope, index)) {
+                flatPoints[index] = value;
+                ok = true;
+            } else if (field == "points_per_minute" && interactionIndex(scope, index)) {
+                pointsPerMinute[index] = value;
+                ok = true;
+            } else if (field == "multiplier" && customerIndex(scope, index)) {
+                kindMultipliers[index] = value;
+                ok = true;
+            }
+        }
+        
+        // Anything left over after the key or the values makes the line malformed
+        std::string extra;
+        if (!ok || keyStream >> extra || !(valueStream >> std::ws).eof()) {
+            error = "line " + std::to_string(lineNumber) + ": cannot parse '" + key + "'";
+            return false;
+        }
+    }
+    std::sort(corporateTiers.begin(), corporateTiers.end(),
+        [](const CorporateTier& a, const CorporateTier& b) { return a.minEmployees < b.minEmployees; });
+    return true;
+}
+
+bool ScoringRules::loadFromFile(const std::string& path, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    return parse(in, error);
+}
@@ -0,0 +1,132 @@
+// CRM network server
+// server_main.cpp
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+#include "crm/admin_server.h"
+#include "crm/crm.h"
+#include "crm/crm_server.h"
+#include "crm/logger.h"
+#include "crm/replica_follower.h"
+#include "crm/replication_log.h"
+
+static void printUsage(const char* program) {
+    std::cerr << "usage: " << program << " [--host ADDRESS] [--port PORT] [--admin SOCKET_PATH]\n"
+              << "       [--follow ADDRESS:PORT] [--log-capacity MB] [--shard I/N]\n"
+              << "  --host ADDRESS          IPv4 address to listen on (default 127.0.0.1)\n"
+              << "  --port PORT             TCP port (default 7070, 0 picks a free one)\n"
+              << "  --admin SOCKET_PATH     also serve admin commands on a Unix socket\n"
+              << "  --follow ADDRESS:PORT   run as a read-only replica of that primary\n"
+              << "  --log-capacity MB       replication log kept for replicas (default 64, 0 disables)\n"
+              << "  --shard I/N             serve shard I (from 0) of N behind a crm_router\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string host = "127.0.0.1";
+    unsigned long port = 7070;
+    std::string adminPath;
+    std::string primary;
+    unsigned long logCapacityMb = ReplicationLog::kDefaultCapacity / (1024 * 1024);
+    std::string shard;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--host") host = value;
+        else if (arg == "--port" && (port = std::strtoul(value, nullptr, 10)) <= 65535) {}
+        else if (arg == "--admin") adminPath = value;
+        else if (arg == "--follow") primary = value;
+        else if (arg == "--log-capacity") logCapacityMb = std::strtoul(value, nullptr, 10);
+        else if (arg == "--shard") shard = value;
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    // Per-request log lines would dominate the cost of serving
+    Logger::instance().setLevel(LogLevel::Warning);
+    raiseDescriptorLimit();
+    
+    // Block the signals before any thread starts so only sigwait sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    
+    std::string primaryHost;
+    unsigned long primaryPort = 0;
+    if (!primary.empty()) {
+        size_t colon = primary.rfind(':');
+        if (colon == std::string::npos || (primaryPort = std::strtoul(primary.c_str() + colon + 1, nullptr, 10)) == 0 || 
+            primaryPort > 65535) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        primaryHost = primary.substr(0, colon);
+    }
+    
+    // Shard i of n hands out customer ids i + 1, i + 1 + n, ... (see ShardRouter)
+    unsigned long shardIndex = 0;
+    unsigned long shardCount = 1;
+    if (!shard.empty()) {
+        char* end = nullptr;
+        shardIndex = std::strtoul(shard.c_str(), &end, 10);
+        if (*end != '/' || (shardCount = std::strtoul(end + 1, nullptr, 10)) == 0 || shardIndex >= shardCount) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    CRM crm;
+    crm.setCustomerIdSpace(static_cast<int>(shardIndex) + 1, static_cast<int>(shardCount));
+    std::mutex crmMutex;
+    CrmServer server(crm, crmMutex);
+    
+    // A primary logs its mutations for replicas; a replica only serves reads
+    ReplicationLog log(logCapacityMb * 1024 * 1024);
+    ReplicaFollower follower(crm, crmMutex);
+    if (!primaryHost.empty())
+        server.setReadOnly(true);
+    else if (logCapacityMb > 0)
+        server.setReplicationLog(&log);
+    
+    if (!server.start(host, static_cast<uint16_t>(port))) {
+        std::cerr << "Could not start server on " << host << ":" << port << std::endl;
+        return 1;
+    }
+    std::cout << "CRM server listening on " << host << ":" << server.getPort() << std::endl;
+    
+    if (!primaryHost.empty()) {
+        if (!follower.start(primaryHost, static_cast<uint16_t>(primaryPort))) {
+            std::cerr << "Could not follow " << primary << std::endl;
+            return 1;
+        }
+        std::cout << "Replicating from " << primary << std::endl;
+    }
+    
+    AdminServer admin(crm, crmMutex);
+    if (!adminPath.empty()) {
+        if (!admin.start(adminPath)) {
+            std::cerr << "Could not start admin server on " << adminPath << std::endl;
+            return 1;
+        }
+        std::cout << "Admin server listening on " << adminPath << std::endl;
+    }
+    
+    int signal = 0;
+    sigwait(&signals, &signal);
+    admin.stop();
+    follower.stop();
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,431 @@
+// Binary request/response protocol of the CRM network service
+// service_protocol.cpp
+
+#include "crm/service_protocol.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+void putU8(std::string& out, uint8_t value) {
+    out += static_cast<char>(value);
+}
+
+void putU32(std::string& out, uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i)
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    out.append(bytes, 4);
+}
+
+void putU64(std::string& out, uint64_t value) {
+    putU32(out, static_cast<uint32_t>(value));
+    putU32(out, static_cast<uint32_t>(value >> 32));
+}
+
+void putF64(std::string& out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putU64(out, bits);
+}
+
+void putString(std::string& out, const std::string& value) {
+    putU32(out, static_cast<uint32_t>(value.size()));
+    out += value;
+}
+
+void putCustomerTotals(std::string& out, const ReportSummary::CustomerTotals& customer) {
+    putU32(out, static_cast<uint32_t>(customer.id));
+    putString(out, customer.name);
+    putU8(out, static_cast<uint8_t>(customer.kind));
+    putU32(out, static_cast<uint32_t>(customer.minutes));
+}
+
+void putSummary(std::string& out, const ReportSummary& summary) {
+    for (uint32_t count : summary.customersByKind)
+        putU32(out, count);
+    putU64(out, static_cast<uint64_t>(summary.interactionMinutes));
+    putU64(out, static_cast<uint64_t>(summary.contractCents));
+    putU32(out, static_cast<uint32_t>(summary.reps.size()));
+    for (const auto& rep : summary.reps) {
+        putString(out, rep.name);
+        putU64(out, static_cast<uint64_t>(rep.contractCents));
+        putU32(out, static_cast<uint32_t>(rep.customers.size()));
+        for (const auto& customer : rep.customers)
+            putCustomerTotals(out, customer);
+    }
+    putU32(out, static_cast<uint32_t>(summary.top.size()));
+    for (const auto& customer : summary.top)
+        putCustomerTotals(out, customer);
+}
+
+uint32_t loadU32(const char* data) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    return value;
+}
+
+// Reserve the length header of a frame, to be filled in by endFrame
+size_t beginFrame(std::string& out) {
+    size_t start = out.size();
+    out.append(4, '\0');
+    return start;
+}
+
+void endFrame(std::string& out, size_t start) {
+    uint32_t length = static_cast<uint32_t>(out.size() - start - 4);
+    for (int i = 0; i < 4; ++i)
+        out[start + i] = static_cast<char>((length >> (8 * i)) & 0xFF);
+}
+
+// Bounds-checked reader over a frame payload; reads past the end fail the whole decode
+class PayloadReader {
+private:
+    const char* data;
+    size_t remaining;
+    bool valid = true;
+    
+    bool take(size_t bytes) {
+        if (!valid || remaining < bytes) {
+            valid = false;
+            return false;
+        }
+        return true;
+    }
+    
+    void skip(size_t bytes) {
+        data += bytes;
+        remaining -= bytes;
+    }
+
+public:
+    PayloadReader(const char* data, size_t size) : data(data), remaining(size) {}
+    
+    uint8_t u8() {
+        if (!take(1))
+            return 0;
+        uint8_t value = static_cast<uint8_t>(*data);
+        skip(1);
+        return value;
+    }
+    
+    uint32_t u32() {
+        if (!take(4))
+            return 0;
+        uint32_t value = loadU32(data);
+        skip(4);
+        return value;
+    }
+    
+    uint64_t u64() {
+        uint64_t value = u32();
+        return value | static_cast<uint64_t>(u32()) << 32;
+    }
+    
+    double f64() {
+        uint64_t bits = u64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    
+    void string(std::string& value) {
+        uint32_t length = u32();
+        if (!take(length))
+            return;
+        value.assign(data, length);
+        skip(length);
+    }
+    
+    // The payload of a nested frame; false if it does not fit
+    bool frame(const char*& payload, size_t& size) {
+        uint32_t length = u32();
+        if (!take(length))
+            return false;
+        payload = data;
+        size = length;
+        skip(length);
+        return true;
+    }
+    
+    // A count of entries that each take at least minBytes; 0 and a failed decode if they cannot fit
+    uint32_t count(size_t minBytes) {
+        uint32_t value = u32();
+        if (value > remaining / minBytes) {
+            valid = false;
+            return 0;
+        }
+        return value;
+    }
+    
+    // True if every read was in bounds and the whole payload was consumed
+    bool finished() const { return valid && remaining == 0; }
+};
+
+void readCustomerTotals(PayloadReader& in, ReportSummary::CustomerTotals& customer) {
+    customer.id = static_cast<int>(in.u32());
+    in.string(customer.name);
+    customer.kind = static_cast<CustomerKind>(in.u8());
+    customer.minutes = static_cast<int>(in.u32());
+}
+
+void readSummary(PayloadReader& in, ReportSummary& summary) {
+    for (uint32_t& count : summary.customersByKind)
+        count = in.u32();
+    summary.interactionMinutes = static_cast<int64_t>(in.u64());
+    summary.contractCents = static_cast<int64_t>(in.u64());
+    summary.reps.resize(in.count(16));
+    for (auto& rep : summary.reps) {
+        in.string(rep.name);
+        rep.contractCents = static_cast<int64_t>(in.u64());
+        rep.customers.resize(in.count(13));
+        for (auto& customer : rep.customers)
+            readCustomerTotals(in, customer);
+    }
+    summary.top.resize(in.count(13));
+    for (auto& customer : summary.top)
+        readCustomerTotals(in, customer);
+}
+
+}  // namespace
+
+size_t serviceFrameSize(const char* data, size_t size) {
+    if (size < 4)
+        return 0;
+    uint32_t length = loadU32(data);
+    if (length > kMaxServiceFrame)
+        return SIZE_MAX;
+    return size - 4 >= length ? length + 4 : 0;
+}
+
+void encodeServiceRequest(const ServiceRequest& request, std::string& out) {
+    size_t start = beginFrame(out);
+    putU8(out, static_cast<uint8_t>(request.op));
+    putU32(out, request.id);
+    switch (request.op) {
+        case ServiceOp::CreateCustomer:
+            putU8(out, static_cast<uint8_t>(request.kind));
+            putString(out, request.name);
+            putString(out, request.email);
+            putString(out, request.phone);
+            putString(out, request.group);
+            putU32(out, request.employees);
+            putF64(out, request.annualContract);
+            break;
+        case ServiceOp::CreateRep:
+            putString(out, request.name);
+            break;
+        case ServiceOp::Assign:
+            putU32(out, request.customerId);
+            putU32(out, request.repId);
+            break;
+        case ServiceOp::RecordCall:
+            putU32(out, request.repId);
+            putU32(out, request.customerId);
+            putString(out, request.content);
+            putU32(out, request.minutes);
+            break;
+        case ServiceOp::RecordEmail:
+            putU32(out, request.repId);
+            putU32(out, request.customerId);
+            putString(out, request.content);
+            putString(out, request.detail);
+            break;
+        case ServiceOp::RecordMeeting:
+            putU32(out, request.repId);
+            putU32(out, request.customerId);
+            putString(out, request.content);
+            putString(out, request.detail);
+            putU32(out, request.minutes);
+            break;
+        case ServiceOp::GetCustomer:
+            putU32(out, request.customerId);
+            break;
+        case ServiceOp::Report:
+        case ServiceOp::Summary:
+            putU8(out, static_cast<uint8_t>(request.report));
+            putU32(out, request.count);
+            break;
+        case ServiceOp::Batch:
+            putU32(out, static_cast<uint32_t>(request.batch.size()));
+            for (const auto& item : request.batch)
+                encodeServiceRequest(item, out);
+            break;
+        case ServiceOp::Subscribe:
+            putU64(out, request.sequence);
+            break;
+    }
+    endFrame(out, start);
+}
+
+bool decodeServiceRequest(const char* payload, size_t size, ServiceRequest& request) {
+    PayloadReader in(payload, size);
+    request.op = static_cast<ServiceOp>(in.u8());
+    request.id = in.u32();
+    switch (request.op) {
+        case ServiceOp::CreateCustomer: {
+            uint8_t kind = in.u8();
+            if (kind > static_cast<uint8_t>(CustomerKind::Corporate))
+                return false;
+            request.kind = static_cast<CustomerKind>(kind);
+            in.string(request.name);
+            in.string(request.email);
+            in.string(request.phone);
+            in.string(request.group);
+            request.employees = in.u32();
+            request.annualContract = in.f64();
+            break;
+        }
+        case ServiceOp::CreateRep:
+            in.string(request.name);
+            break;
+        case ServiceOp::Assign:
+            request.customerId = in.u32();
+            request.repId = in.u32();
+            break;
+        case ServiceOp::RecordCall:
+            request.repId = in.u32();
+            request.customerId = in.u32();
+            in.string(request.content);
+            request.minutes = in.u32();
+            break;
+        case ServiceOp::RecordEmail:
+            request.repId = in.u32();
+            request.customerId = in.u32();
+            in.string(request.content);
+            in.string(request.detail);
+            break;
+        case ServiceOp::RecordMeeting:
+            request.repId = in.u32();
+            request.customerId = in.u32();
+            in.string(request.content);
+            in.string(request.detail);
+            request.minutes = in.u32();
+            break;
+        case ServiceOp::GetCustomer:
+            request.customerId = in.u32();
+            break;
+        case ServiceOp::Report:
+        case ServiceOp::Summary: {
+            uint8_t report = in.u8();
+            if (report > static_cast<uint8_t>(ServiceReport::Top))
+                return false;
+            request.report = static_cast<ServiceReport>(report);
+            request.count = in.u32();
+            break;
+        }
+        case ServiceOp::Batch: {
+            // Every nested frame takes at least 9 bytes, which bounds the count
+            uint32_t count = in.u32();
+            if (count > size / 9)
+                return false;
+            request.batch.resize(count);
+            for (auto& item : request.batch) {
+                const char* itemPayload;
+                size_t itemSize;
+                if (!in.frame(itemPayload, itemSize) || !decodeServiceRequest(itemPayload, itemSize, item) || 
+                    item.op == ServiceOp::Batch)
+                    return false;
+            }
+            break;
+        }
+        case ServiceOp::Subscribe:
+            request.sequence = in.u64();
+            break;
+        default:
+            return false;
+    }
+    return in.finished();
+}
+
+void encodeServiceResponse(const ServiceResponse& response, std::string& out) {
+    size_t start = beginFrame(out);
+    putU8(out, static_cast<uint8_t>(response.op));
+    putU32(out, response.id);
+    putU8(out, static_cast<uint8_t>(response.status));
+    if (response.status == ServiceStatus::Ok) {
+        switch (response.op) {
+            case ServiceOp::CreateCustomer:
+            case ServiceOp::CreateRep:
+                putU32(out, response.value);
+                break;
+            case ServiceOp::GetCustomer:
+                putU8(out, static_cast<uint8_t>(response.kind));
+                putU32(out, response.repId);
+                putU32(out, response.minutes);
+                putString(out, response.name);
+                putString(out, response.email);
+                putString(out, response.phone);
+                break;
+            case ServiceOp::Report:
+                putString(out, response.text);
+                break;
+            case ServiceOp::Batch:
+                putU32(out, static_cast<uint32_t>(response.batch.size()));
+                for (const auto& item : response.batch)
+                    encodeServiceResponse(item, out);
+                break;
+            case ServiceOp::Subscribe:
+                putU32(out, response.value);
+                putU64(out, response.sequence);
+                break;
+            case ServiceOp::Summary:
+                putSummary(out, response.summary);
+                break;
+            default:
+                break;
+        }
+    }
+    endFrame(out, start);
+}
+
+bool decodeServiceResponse(const char* payload, size_t size, ServiceResponse& response) {
+    PayloadReader in(payload, size);
+    response.op = static_cast<ServiceOp>(in.u8());
+    response.id = in.u32();
+    response.status = static_cast<ServiceStatus>(in.u8());
+    if (response.status == ServiceStatus::Ok) {
+        switch (response.op) {
+            case ServiceOp::CreateCustomer:
+            case ServiceOp::CreateRep:
+                response.value = in.u32();
+                break;
+            case ServiceOp::GetCustomer:
+                response.kind = static_cast<CustomerKind>(in.u8());
+                response.repId = in.u32();
+                response.minutes = in.u32();
+                in.string(response.name);
+                in.string(response.email);
+                in.string(response.phone);
+                break;
+            case ServiceOp::Report:
+                in.string(response.text);
+                break;
+            case ServiceOp::Batch: {
+                uint32_t count = in.u32();
+                if (count > size / 9)
+                    return false;
+                response.batch.resize(count);
+                for (auto& item : response.batch) {
+                    const char* itemPayload;
+                    size_t itemSize;
+                    if (!in.frame(itemPayload, itemSize) || !decodeServiceResponse(itemPayload, itemSize, item))
+                        return false;
+                }
+                break;
+            }
+            case ServiceOp::Subscribe:
+                response.value = in.u32();
+                response.sequence = in.u64();
+                break;
+            case ServiceOp::Summary:
+                readSummary(in, response.summary);
+                break;
+            default:
+                break;
+        }
+    }
+    return in.finished();
+}
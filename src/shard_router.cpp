@@ -0,0 +1,264 @@
+// Front end for customers partitioned across several CRM servers
+// shard_router.cpp
+
+#include "crm/shard_router.h"
+
+#include <sstream>
+#include <utility>
+
+#include "crm/logger.h"
+
+namespace {
+
+// FNV-1a, so placement does not depend on the standard library's hash
+uint64_t hashKey(const std::string& key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+}  // namespace
+
+ShardRouter::ShardRouter(const std::vector<std::pair<std::string, uint16_t>>& addresses, int timeoutMs) {
+    for (const auto& address : addresses) {
+        auto shard = std::make_unique<Shard>();
+        shard->host = address.first;
+        shard->port = address.second;
+        shard->client.setTimeout(timeoutMs);
+        shard->batch.op = ServiceOp::Batch;
+        shards.push_back(std::move(shard));
+    }
+}
+
+size_t ShardRouter::shardForNewCustomer(const ServiceRequest& request) const {
+    return hashKey(request.email.empty() ? request.name : request.email) % shards.size();
+}
+
+size_t ShardRouter::handleFrames(const char* data, size_t size, std::string& output, uint64_t*) {
+    size_t consumed = 0;
+    size_t count = 0;
+    while (true) {
+        size_t frame = serviceFrameSize(data + consumed, size - consumed);
+        if (frame == SIZE_MAX)
+            return SIZE_MAX;
+        if (frame == 0)
+            break;
+        if (count == requests.size())
+            requests.emplace_back();
+        decoded.resize(count + 1);
+        decoded[count] = decodeServiceRequest(data + consumed + 4, frame - 4, requests[count]);
+        count++;
+        consumed += frame;
+    }
+    if (count == 0)
+        return 0;
+    
+    responses.resize(count);
+    pending.clear();
+    broadcastItems.clear();
+    for (auto& shard : shards)
+        shard->batch.batch.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (decoded[i]) {
+            route(requests[i], responses[i]);
+        } else {
+            responses[i].op = requests[i].op;
+            responses[i].id = requests[i].id;
+            responses[i].status = ServiceStatus::BadRequest;
+        }
+    }
+    
+    roundTrip();
+    for (const Pending& entry : pending)
+        complete(entry);
+    for (size_t i = 0; i < count; ++i)
+        encodeServiceResponse(responses[i], output);
+    return consumed;
+}
+
+void ShardRouter::route(const ServiceRequest& request, ServiceResponse& response) {
+    response.op = request.op;
+    response.id = request.id;
+    response.status = ServiceStatus::Ok;
+    switch (request.op) {
+        case ServiceOp::CreateCustomer:
+            forward(request, response, shardForNewCustomer(request));
+            break;
+        case ServiceOp::CreateRep:
+            if (repIdsDiverged || !connectAll())
+                response.status = ServiceStatus::Unavailable;
+            else
+                forward(request, response, kAllShards);
+            break;
+        case ServiceOp::Report:
+        case ServiceOp::Summary:
+            forward(request, response, kAllShards);
+            break;
+        case ServiceOp::Assign:
+        case ServiceOp::RecordCall:
+        case ServiceOp::RecordEmail:
+        case ServiceOp::RecordMeeting:
+        case ServiceOp::GetCustomer:
+            if (request.customerId == 0)
+                response.status = ServiceStatus::NotFound;
+            else if (repIdsDiverged && request.op != ServiceOp::GetCustomer)
+                response.status = ServiceStatus::Unavailable;
+            else
+                forward(request, response, shardOfCustomer(request.customerId));
+            break;
+        case ServiceOp::Batch:
+            response.batch.resize(request.batch.size());
+            for (size_t i = 0; i < request.batch.size(); ++i)
+                route(request.batch[i], response.batch[i]);
+            break;
+        default:
+            response.status = ServiceStatus::BadRequest;
+            break;
+    }
+}
+
+void ShardRouter::forward(const ServiceRequest& request, ServiceResponse& response, size_t shard) {
+    // Shards are asked for summaries, which add up, instead of report text
+    auto queue = [&request](Shard& target) {
+        target.batch.batch.push_back(request);
+        if (request.op == ServiceOp::Report)
+            target.batch.batch.back().op = ServiceOp::Summary;
+        return target.batch.batch.size() - 1;
+    };
+    
+    if (shard != kAllShards) {
+        pending.push_back({&request, &response, shard, queue(*shards[shard])});
+        return;
+    }
+    pending.push_back({&request, &response, kAllShards, broadcastItems.size()});
+    for (auto& target : shards)
+        broadcastItems.push_back(queue(*target));
+}
+
+bool ShardRouter::connectAll() {
+    bool connected = true;
+    for (auto& shard : shards) {
+        if (!shard->client.isConnected() && !shard->client.connect(shard->host, shard->port)) {
+            CRM_LOG(LogLevel::Warning, "Could not connect to shard " << shard->host << ":" << shard->port);
+            connected = false;
+        }
+    }
+    return connected;
+}
+
+void ShardRouter::roundTrip() {
+    for (auto& shard : shards) {
+        shard->failed = false;
+        if (shard->batch.batch.empty())
+            continue;
+        if (!shard->client.isConnected() && !shard->client.connect(shard->host, shard->port)) {
+            CRM_LOG(LogLevel::Warning, "Could not connect to shard " << shard->host << ":" << shard->port);
+            shard->failed = true;
+            continue;
+        }
+        shard->client.send(shard->batch);
+        if (!shard->client.flush()) {
+            shard->client.close();
+            shard->failed = true;
+        }
+    }
+    
+    for (auto& shard : shards) {
+        if (shard->batch.batch.empty() || shard->failed)
+            continue;
+        ServiceResponse& response = shard->response;
+        if (!shard->client.receive(response) || response.op != ServiceOp::Batch || 
+            response.status != ServiceStatus::Ok || response.batch.size() != shard->batch.batch.size()) {
+            CRM_LOG(LogLevel::Warning, "Lost connection to shard " << shard->host << ":" << shard->port
+                                       << " or it did not answer in time");
+            shard->client.close();
+            shard->failed = true;
+        }
+    }
+}
+
+void ShardRouter::complete(const Pending& entry) {
+    ServiceResponse& response = *entry.response;
+    if (entry.shard != kAllShards) {
+        Shard& shard = *shards[entry.shard];
+        if (shard.failed) {
+            response.status = ServiceStatus::Unavailable;
+            return;
+        }
+        std::swap(response, shard.response.batch[entry.item]);
+        response.id = entry.request->id;
+        return;
+    }
+    if (entry.request->op == ServiceOp::CreateRep) {
+        completeCreateRep(entry);
+        return;
+    }
+    
+    for (size_t i = 0; i < shards.size(); ++i) {
+        const Shard& shard = *shards[i];
+        if (shard.failed) {
+            response.status = ServiceStatus::Unavailable;
+            return;
+        }
+        const ServiceResponse& reply = shard.response.batch[broadcastItems[entry.item + i]];
+        if (reply.status != ServiceStatus::Ok) {
+            response.status = reply.status;
+            return;
+        }
+    }
+    
+    const ServiceRequest& request = *entry.request;
+    size_t topK = request.report == ServiceReport::Top ? request.count : 0;
+    ReportSummary summary;
+    for (size_t i = 0; i < shards.size(); ++i)
+        summary.merge(shards[i]->response.batch[broadcastItems[entry.item + i]].summary, topK);
+    if (request.op == ServiceOp::Summary) {
+        response.summary = std::move(summary);
+        return;
+    }
+    
+    std::ostringstream out;
+    if (request.report == ServiceReport::System)
+        summary.writeSystemReport(out);
+    else if (request.report == ServiceReport::Revenue)
+        summary.writeRevenueReport(out);
+    else if (request.report == ServiceReport::Reps)
+        summary.writeInteractionTimeReports(out);
+    else
+        summary.writeTopCustomers(request.count, out);
+    response.text = out.str();
+}
+
+void ShardRouter::completeCreateRep(const Pending& entry) {
+    ServiceResponse& response = *entry.response;
+    ServiceStatus failure = ServiceStatus::Ok;
+    size_t created = 0;
+    bool sameIds = true;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        const Shard& shard = *shards[i];
+        const ServiceResponse* reply = shard.failed ? nullptr : &shard.response.batch[broadcastItems[entry.item + i]];
+        if (!reply || reply->status != ServiceStatus::Ok) {
+            if (failure == ServiceStatus::Ok)
+                failure = reply ? reply->status : ServiceStatus::Unavailable;
+            continue;
+        }
+        if (created++ == 0)
+            response.value = reply->value;
+        else
+            sameIds = sameIds && reply->value == response.value;
+    }
+    if (created == shards.size() && sameIds)
+        return;
+    
+    response.value = 0;
+    response.status = created == 0 ? failure : ServiceStatus::Unavailable;
+    if (created > 0) {
+        // Some shards used up a rep id the others did not; rep ids no longer line up
+        repIdsDiverged = true;
+        CRM_LOG(LogLevel::Warning, "Rep " << entry.request->name << " was not created on every shard "
+                                   "with the same id; rejecting requests that name a rep");
+    }
+}
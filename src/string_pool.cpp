@@ -0,0 +1,46 @@
+// Interned string storage shared by customer and interaction fields
+// string_pool.cpp
+
+#include "crm/string_pool.h"
+
+#include "crm/memory_usage.h"
+
+StringPool& StringPool::global() {
+    static StringPool pool;
+    return pool;
+}
+
+uint32_t StringPool::intern(std::string_view value) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = ids.find(value);
+        if (it != ids.end())
+            return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto it = ids.find(value);
+    if (it != ids.end())
+        return it->second;
+    uint32_t id = static_cast<uint32_t>(values.size());
+    values.emplace_back(value);
+    ids.emplace(values.back(), id);
+    return id;
+}
+
+const std::string& StringPool::lookup(uint32_t id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return values[id];
+}
+
+size_t StringPool::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return values.size();
+}
+
+size_t StringPool::getMemoryUsage() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    size_t bytes = hashTableMemory(ids);
+    for (const std::string& value : values)
+        bytes += sizeof(std::string) + stringMemory(value);
+    return bytes;
+}
@@ -0,0 +1,128 @@
+// Compression for interaction content
+// text_codec.cpp
+
+#include "crm/text_codec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+const std::string& TextCodec::dictionary() {
+    static const std::string dict =
+        "Thank you for your email. Please find attached the proposal and pricing "
+        "details for the contract renewal. Following up on our call regarding the "
+        "quarterly review meeting with the customer about product features, "
+        "technical support, installation, invoice, payment, discount, upgrade, "
+        "subscription, account manager, training session, onboarding, demo, "
+        "schedule a follow-up next week. Discussed new requirements and feedback. "
+        "Sending exclusive offer details. Client's Office, Headquarters, ";
+    return dict;
+}
+
+uint32_t TextCodec::read32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+void TextCodec::writeLength(std::string& out, size_t length) {
+    while (length >= 255) {
+        out += static_cast<char>(255);
+        length -= 255;
+    }
+    out += static_cast<char>(length);
+}
+
+bool TextCodec::readLength(const std::string& in, size_t& pos, size_t& length) {
+    unsigned char byte;
+    do {
+        if (pos >= in.size())
+            return false;
+        byte = static_cast<unsigned char>(in[pos++]);
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+void TextCodec::writeSequence(std::string& out, const char* literals, size_t literalLength,
+                              size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength ? matchLength - kMinMatch : 0;
+    out += static_cast<char>((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchCode, 15));
+    if (literalLength >= 15)
+        writeLength(out, literalLength - 15);
+    out.append(literals, literalLength);
+    if (matchLength) {
+        out += static_cast<char>(offset & 0xFF);
+        out += static_cast<char>(offset >> 8);
+        if (matchCode >= 15)
+            writeLength(out, matchCode - 15);
+    }
+}
+
+std::string TextCodec::compress(const std::string& input) {
+    const std::string& dict = dictionary();
+    std::string window = dict + input;
+    const char* base = window.data();
+    size_t end = window.size();
+    
+    std::vector<int32_t> table(size_t(1) << kHashBits, -1);
+    for (size_t i = 0; i + kMinMatch <= dict.size(); ++i)
+        table[hash(read32(base + i))] = static_cast<int32_t>(i);
+    
+    std::string out;
+    size_t anchor = dict.size();
+    size_t pos = dict.size();
+    while (pos + kMinMatch <= end) {
+        size_t slot = hash(read32(base + pos));
+        int32_t candidate = table[slot];
+        table[slot] = static_cast<int32_t>(pos);
+        if (candidate < 0 || pos - candidate > 0xFFFF || 
+            read32(base + candidate) != read32(base + pos)) {
+            ++pos;
+            continue;
+        }
+        size_t length = kMinMatch;
+        while (pos + length < end && base[candidate + length] == base[pos + length])
+            ++length;
+        writeSequence(out, base + anchor, pos - anchor, pos - candidate, length);
+        pos += length;
+        anchor = pos;
+    }
+    writeSequence(out, base + anchor, end - anchor, 0, 0);
+    return out;
+}
+
+bool TextCodec::decompress(const std::string& input, std::string& output) {
+    const std::string& dict = dictionary();
+    std::string window = dict;
+    size_t pos = 0;
+    while (pos < input.size()) {
+        unsigned char token = static_cast<unsigned char>(input[pos++]);
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(input, pos, literalLength))
+            return false;
+        if (pos + literalLength > input.size())
+            return false;
+        window.append(input, pos, literalLength);
+        pos += literalLength;
+        if (pos == input.size())
+            break;
+        
+        if (pos + 2 > input.size())
+            return false;
+        size_t offset = static_cast<unsigned char>(input[pos]) | 
+                        (static_cast<size_t>(static_cast<unsigned char>(input[pos + 1])) << 8);
+        pos += 2;
+        size_t matchLength = token & 0x0F;
+        if (matchLength == 15 && !readLength(input, pos, matchLength))
+            return false;
+        matchLength += kMinMatch;
+        if (offset == 0 || offset > window.size())
+            return false;
+        size_t from = window.size() - offset;
+        for (size_t i = 0; i < matchLength; ++i)
+            window += window[from + i];
+    }
+    output.assign(window, dict.size(), std::string::npos);
+    return true;
+}
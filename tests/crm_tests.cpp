@@ -0,0 +1,1803 @@
+// Unit tests for the CRM core library
+// crm_tests.cpp
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "crm/admin_server.h"
+#include "crm/crm.h"
+#include "crm/crm_service.h"
+#include "crm/duplicate_detector.h"
+#include "crm/interaction_index.h"
+#include "crm/logger.h"
+#include "crm/loyalty_ledger.h"
+#include "crm/metrics.h"
+#include "crm/replication_log.h"
+#include "crm/scoring_rules.h"
+#include "crm/service_protocol.h"
+#include "crm/slot_map.h"
+#include "crm/string_pool.h"
+#include "crm/text_codec.h"
+
+static int failures = 0;
+
+#define CHECK(condition)                                                          \
+    do {                                                                          \
+        if (!(condition)) {                                                       \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: "        \
+                      << #condition << std::endl;                                 \
+            failures++;                                                           \
+        }                                                                         \
+    } while (0)
+
+// Silences std::cout for the lifetime of the object
+class QuietOutput {
+private:
+    std::ostringstream sink;
+    std::streambuf* previous;
+
+public:
+    QuietOutput() : previous(std::cout.rdbuf(sink.rdbuf())) {}
+    ~QuietOutput() { std::cout.rdbuf(previous); }
+};
+
+static void testSlotMapHandles() {
+    SlotMap<std::string> map;
+    auto first = map.emplace("first");
+    auto second = map.emplace("second");
+    CHECK(map.size() == 2);
+    CHECK(*map.get(first) == "first");
+    
+    CHECK(map.erase(first));
+    CHECK(map.get(first) == nullptr);
+    CHECK(!map.erase(first));
+    
+    // The freed slot is reused with a new generation
+    auto third = map.emplace("third");
+    CHECK(third.index() == first.index());
+    CHECK(third != first);
+    CHECK(map.get(first) == nullptr);
+    CHECK(*map.get(third) == "third");
+    CHECK(*map.get(second) == "second");
+    CHECK(map.get(Handle<std::string>()) == nullptr);
+}
+
+static void testStringPool() {
+    InternedString a("Headquarters");
+    InternedString b(std::string("Headquarters"));
+    InternedString c("Client's Office");
+    CHECK(a == b);
+    CHECK(a.getId() != c.getId());
+    CHECK(a.str() == "Headquarters");
+    CHECK(InternedString().str().empty());
+}
+
+static void testTextCodecRoundTrip() {
+    std::vector<std::string> samples = {
+        "",
+        "ok",
+        "Discussed new product features",
+        "Thank you for your email. Please find attached the proposal and pricing details.",
+        std::string(5000, 'a'),
+        "renewal renewal renewal renewal renewal renewal renewal renewal renewal",
+    };
+    for (const auto& text : samples) {
+        std::string decoded;
+        CHECK(TextCodec::decompress(TextCodec::compress(text), decoded));
+        CHECK(decoded == text);
+    }
+    
+    std::string note = "Following up on our call regarding the contract renewal and pricing details";
+    CHECK(TextCodec::compress(note).size() < note.size());
+    
+    std::string decoded;
+    CHECK(!TextCodec::decompress(std::string("\x04\x01", 2), decoded));
+}
+
+static void testInteractionIndexSearch() {
+    InteractionIndex index;
+    index.addInteraction(1, 0, "Quarterly review meeting at Headquarters");
+    index.addInteraction(1, 1, "Contract renewal discussion");
+    index.addInteraction(2, 0, "Review of the contract terms");
+    index.addInteraction(3, 0, "Technical support for recent installation");
+    
+    CHECK(index.search("contract").size() == 2);
+    CHECK(index.search("contract renewal").size() == 1);
+    CHECK(index.search("\"quarterly review\"").size() == 1);
+    CHECK(index.search("\"review quarterly\"").empty());
+    CHECK(index.search("installation OR renewal").size() == 2);
+    CHECK(index.search("CONTRACT Terms").size() == 1);
+    
+    auto hits = index.search("review");
+    CHECK(hits.size() == 2);
+    CHECK(hits[0].customerId == 1 && hits[0].interactionIndex == 0);
+    CHECK(hits[1].customerId == 2);
+    
+    index.removeCustomer(2);
+    CHECK(index.search("review").size() == 1);
+}
+
+static void testInteractionIndexSkips() {
+    // Enough documents for many skip blocks; a rare term makes the common ones skip ahead
+    const char* words[] = {"renewal", "pricing", "next", "week", "contract", "support"};
+    std::mt19937 rng(7);
+    InteractionIndex index;
+    std::vector<std::vector<std::string>> texts;
+    for (int doc = 0; doc < 5000; ++doc) {
+        std::string text;
+        for (size_t i = 0, count = 3 + rng() % 8; i < count; ++i)
+            text += std::string(words[rng() % 6]) + " ";
+        if (doc % 97 == 0)
+            text += "escalated";
+        index.addInteraction(doc, 0, text);
+        texts.push_back(InteractionIndex::tokenize(text));
+    }
+    
+    // Each query against a scan of the documents, as lists of AND clauses of phrases
+    auto contains = [](const std::vector<std::string>& terms, const std::vector<std::string>& phrase) {
+        for (size_t start = 0; start + phrase.size() <= terms.size(); ++start) {
+            if (std::equal(phrase.begin(), phrase.end(), terms.begin() + static_cast<long>(start)))
+                return true;
+        }
+        return false;
+    };
+    using Clause = std::vector<std::vector<std::string>>;
+    std::vector<std::pair<std::string, std::vector<Clause>>> queries = {
+        {"renewal", {{{"renewal"}}}},
+        {"escalated pricing", {{{"escalated"}, {"pricing"}}}},
+        {"\"next week\" escalated", {{{"next", "week"}, {"escalated"}}}},
+        {"\"week renewal renewal\" support", {{{"week", "renewal", "renewal"}, {"support"}}}},
+        {"escalated contract OR \"pricing pricing\"", {{{"escalated"}, {"contract"}}, {{"pricing", "pricing"}}}},
+        {"escalated missing", {{{"escalated"}, {"missing"}}}},
+    };
+    for (const auto& query : queries) {
+        std::vector<int> expected;
+        for (int doc = 0; doc < static_cast<int>(texts.size()); ++doc) {
+            bool any = false;
+            for (const Clause& clause : query.second) {
+                bool all = true;
+                for (const auto& phrase : clause)
+                    all = all && contains(texts[doc], phrase);
+                any = any || all;
+            }
+            if (any)
+                expected.push_back(doc);
+        }
+        std::vector<int> found;
+        for (const auto& hit : index.search(query.first))
+            found.push_back(hit.customerId);
+        CHECK(found == expected);
+    }
+}
+
+static void testDuplicateDetector() {
+    DuplicateDetector detector;
+    detector.addCustomer(1, "John Doe", "john@example.com", "555-1234");
+    detector.addCustomer(2, "Jane Smith", "jane@example.com", "555-5678");
+    detector.addCustomer(3, "Jon Doe", "JOHN@example.com ", "555 1234");
+    
+    auto pairs = detector.findCandidatePairs(0.6);
+    CHECK(pairs.size() == 1);
+    CHECK(pairs.size() == 1 && pairs[0].firstId == 1 && pairs[0].secondId == 3 && pairs[0].exactMatch);
+    
+    auto matches = detector.checkCustomer("Jane Smyth", "jsmith@other.org", "(555) 5678", 0.6);
+    CHECK(matches.size() == 1 && matches[0].secondId == 2 && matches[0].exactMatch);
+    CHECK(detector.checkCustomer("Zed Quinn", "zq@nowhere.net", "", 0.6).empty());
+    
+    detector.removeCustomer(3);
+    CHECK(detector.findCandidatePairs(0.6).empty());
+    
+    // A phone shared by many customers links them as a chain, not every pair
+    DuplicateDetector switchboard;
+    for (int id = 1; id <= 1000; ++id)
+        switchboard.addCustomer(id, "Employee " + std::to_string(id * 7919),
+                                "e" + std::to_string(id) + "@corp.example", "555-0100");
+    size_t exact = 0;
+    for (const auto& pair : switchboard.findCandidatePairs(1.1))
+        exact += pair.exactMatch;
+    CHECK(exact == 999);
+    
+    // Checking a new customer scores only a bounded share of the shared bucket
+    auto callers = switchboard.checkCustomer("New Caller", "new@corp.example", "555-0100", 0.6);
+    CHECK(callers.size() == DuplicateDetector::kMaxBucketSize);
+    
+    // Removed customers leave every bucket; the members moved into their places stay findable
+    size_t indexed = switchboard.getMemoryUsage();
+    for (int id = 1; id <= 1000; id += 2)
+        switchboard.removeCustomer(id);
+    exact = 0;
+    bool evenOnly = true;
+    for (const auto& pair : switchboard.findCandidatePairs(1.1)) {
+        exact += pair.exactMatch;
+        evenOnly = evenOnly && pair.firstId % 2 == 0 && pair.secondId % 2 == 0;
+    }
+    CHECK(exact == 499 && evenOnly);
+    CHECK(switchboard.checkCustomer("Employee 15838", "e2@corp.example", "", 0.6).size() == 1);
+    for (int id = 2; id <= 1000; id += 2)
+        switchboard.removeCustomer(id);
+    CHECK(switchboard.findCandidatePairs(0.0).empty());
+    CHECK(switchboard.getMemoryUsage() < indexed / 2);
+}
+
+static void testCampaignScheduler() {
+    // Jobs queued behind a busy worker run by priority, then in submission order
+    std::vector<int> order;
+    {
+        CampaignScheduler scheduler(1);
+        std::mutex gate;
+        gate.lock();
+        scheduler.submit(0, [&gate] { std::lock_guard<std::mutex> lock(gate); });
+        for (int job : {21, 1, 22, 0, 23})
+            scheduler.submit(job / 10, [&order, job] { order.push_back(job); });
+        gate.unlock();
+        scheduler.wait();
+    }
+    CHECK((order == std::vector<int>{1, 0, 21, 22, 23}));
+    
+    // Failing jobs are retried up to maxAttempts runs in total
+    CampaignScheduler retrying(2, 0, 3);
+    std::atomic<int> flakyRuns{0};
+    retrying.submit(0, [&flakyRuns] {
+        if (++flakyRuns < 3)
+            throw std::runtime_error("flaky");
+    });
+    retrying.submit(0, [] { throw std::runtime_error("broken"); });
+    retrying.wait();
+    CampaignScheduler::Stats stats = retrying.getStats();
+    CHECK(flakyRuns == 3);
+    CHECK(stats.submitted == 2 && stats.completed == 1 && stats.failed == 1 && stats.retried == 4);
+    CHECK(stats.queueDepth == 0);
+    
+    // The token bucket allows a one-second burst, then throttles to the rate
+    CampaignScheduler limited(4, 200);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 240; ++i)
+        limited.submit(0, [] {});
+    limited.wait();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    CHECK(seconds >= 0.15);
+    CHECK(limited.getStats().completed == 240);
+    
+    // A rate below one per second still holds a whole token, so the job runs at once
+    CampaignScheduler slow(1, 0.5);
+    start = std::chrono::steady_clock::now();
+    slow.submit(0, [] {});
+    slow.wait();
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    CHECK(slow.getStats().completed == 1);
+    CHECK(seconds < 1.0);
+    
+    // Scheduled customer actions are prepared up front, so the CRM may change while they run
+    QuietOutput quiet;
+    CRM crm;
+    auto rep = crm.createSalesRepresentative("Rep");
+    auto regular = crm.createRegularCustomer("Rita", "", "", "Retail");
+    auto vip = crm.createVIPCustomer("Victor", "", "", "Manager");
+    crm.assignCustomerToRep(regular->getId(), rep->getId());
+    crm.assignCustomerToRep(vip->getId(), rep->getId());
+    std::ostringstream out;
+    {
+        CampaignScheduler scheduler(1);
+        std::mutex gate;
+        gate.lock();
+        scheduler.submit(-1, [&gate] { std::lock_guard<std::mutex> lock(gate); });
+        crm.scheduleCampaign(scheduler, out);
+        crm.removeCustomer(regular->getId());
+        gate.unlock();
+        scheduler.wait();
+    }
+    CHECK(out.str() == "Scheduling quarterly review with Victor and account manager Manager\n"
+                       "Sending regular promotional materials to Rita in segment Retail\n");
+}
+
+static void testAsyncLogger() {
+    Logger logger;
+    std::ostringstream sink;
+    logger.setOutput(sink);
+    logger.startAsync();
+    logger.log(LogLevel::Info, "first");
+    std::string longMessage(1000, 'x');
+    logger.log(LogLevel::Info, longMessage);
+    logger.log(LogLevel::Info, "last");
+    logger.flush();
+    // Long messages are written whole, in order with the queued ones
+    CHECK(sink.str() == "first\n" + longMessage + "\nlast\n");
+    
+    // Messages logged while async mode stops are all written or counted as dropped
+    const int kThreads = 4;
+    const int kMessages = 1500;
+    sink.str("");
+    std::atomic<int> started{0};
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&logger, &started, t] {
+            started++;
+            for (int i = 0; i < kMessages; ++i)
+                logger.log(LogLevel::Info, std::to_string(t) + " " + std::to_string(i));
+        });
+    }
+    while (started.load() < kThreads)
+        std::this_thread::yield();
+    logger.stopAsync();
+    for (std::thread& producer : producers)
+        producer.join();
+    
+    std::istringstream lines(sink.str());
+    std::vector<int> lastSeen(kThreads, -1);
+    int written = 0;
+    int thread;
+    int index;
+    bool ordered = true;
+    while (lines >> thread >> index) {
+        ordered = ordered && index > lastSeen[thread];
+        lastSeen[thread] = index;
+        written++;
+    }
+    CHECK(ordered);
+    CHECK(written + static_cast<int>(logger.getDroppedCount()) == kThreads * kMessages);
+    
+    // Async mode can be started again after a stop
+    sink.str("");
+    logger.startAsync();
+    logger.log(LogLevel::Info, "again");
+    logger.stopAsync();
+    CHECK(sink.str() == "again\n");
+    
+    // CRM_LOG formats into a reused per-thread buffer without leaking stream flags
+    Logger& global = Logger::instance();
+    global.setOutput(sink);
+    global.setLevel(LogLevel::Info);
+    sink.str("");
+    CRM_LOG(LogLevel::Info, std::hex << 255 << " " << 1.5);
+    CRM_LOG(LogLevel::Info, 255 << " " << 2.25);
+    CRM_LOG(LogLevel::Debug, "hidden");
+    global.setLevel(LogLevel::Off);
+    global.setOutput(std::cout);
+    CHECK(sink.str() == "ff 1.5\n255 2.25\n");
+}
+
+static void testLoyaltyLedger() {
+    LoyaltyLedger ledger(3);
+    std::vector<std::pair<int, double>> committed;
+    ledger.setCommitCallback([&committed](int customerId, double points) {
+        committed.push_back({customerId, points});
+    });
+    
+    ledger.accrue(7, 10, LoyaltyReason::Email);
+    ledger.accrue(7, 0.5, LoyaltyReason::Call);
+    CHECK(ledger.getPendingCount() == 2);
+    CHECK(ledger.getBalance(7) == 0);
+    
+    // The third accrual fills the batch
+    ledger.accrue(8, 120, LoyaltyReason::Meeting);
+    CHECK(ledger.getPendingCount() == 0);
+    CHECK(ledger.getEntryCount() == 3);
+    CHECK(ledger.getBalance(7) == 10.5);
+    CHECK(ledger.getBalance(8) == 120);
+    CHECK(committed.size() == 2);
+    CHECK(ledger.getHistory(7).size() == 2);
+    CHECK(ledger.getHistory(7)[0].reason == LoyaltyReason::Email);
+}
+
+static void testScoringRulesParse() {
+    ScoringRules rules;
+    std::istringstream config(
+        "# custom rules\n"
+        "call.points_per_minute = 1\n"
+        "email.points = 4   # per email\n"
+        "vip.multiplier = 2\n"
+        "corporate.tier = 50 1.1\n"
+        "corporate.tier = 500 1.4\n");
+    std::string error;
+    CHECK(rules.parse(config, error));
+    CHECK(rules.loyaltyPoints(InteractionKind::Call, 30) == 30);
+    CHECK(rules.loyaltyPoints(InteractionKind::Email, 0) == 4);
+    CHECK(rules.loyaltyPoints(InteractionKind::Meeting, 10) == 20);
+    CHECK(rules.multiplierFor(CustomerKind::VIP) == 2);
+    CHECK(rules.multiplierFor(CustomerKind::Corporate, 10) == 1.0);
+    CHECK(rules.multiplierFor(CustomerKind::Corporate, 100) == 1.1);
+    CHECK(rules.multiplierFor(CustomerKind::Corporate, 1000) == 1.4);
+    
+    ScoringRules broken;
+    std::istringstream bad("email.points = 4\nvip.bonus = 3\n");
+    CHECK(!broken.parse(bad, error));
+    CHECK(error.find("line 2") != std::string::npos);
+    
+    // Trailing tokens after the key or the values are rejected, comments are not
+    for (const char* line : {"email.points = 4 5\n", "email.points = 4x\n", "email.points extra = 4\n",
+                             "corporate.tier = 50 1.1 2\n"}) {
+        ScoringRules trailing;
+        std::istringstream text(line);
+        CHECK(!trailing.parse(text, error));
+    }
+    ScoringRules commented;
+    std::istringstream withComment("email.points = 4   # 4 points\n");
+    CHECK(commented.parse(withComment, error));
+}
+
+static void testScoringRulesPerCrm() {
+    QuietOutput quiet;
+    const char* path = "crm_tests_rules.conf";
+    {
+        std::ofstream out(path);
+        out << "vip.multiplier = 2\nemail.points = 4\n";
+    }
+    CRM custom;
+    CRM standard;
+    VIPCustomer* before = custom.createVIPCustomer("Ann", "ann@example.com", "555-0001", "Kim");
+    CHECK(custom.loadScoringRules(path));
+    std::remove(path);
+    CHECK(before->getInteractionMultiplier() == 2);
+    
+    // Rules loaded into one CRM do not leak into another
+    VIPCustomer* after = custom.createVIPCustomer("Bob", "bob@example.com", "555-0002", "Kim");
+    VIPCustomer* other = standard.createVIPCustomer("Cid", "cid@example.com", "555-0003", "Kim");
+    CHECK(after->getInteractionMultiplier() == 2);
+    CHECK(other->getInteractionMultiplier() == 1.2);
+    
+    SalesRepresentative* customRep = custom.createSalesRepresentative("Rep");
+    SalesRepresentative* standardRep = standard.createSalesRepresentative("Rep");
+    custom.assignCustomerToRep(after->getId(), customRep->getId());
+    standard.assignCustomerToRep(other->getId(), standardRep->getId());
+    CHECK(customRep->recordEmail(after->getId(), "Hi", "Hello"));
+    CHECK(standardRep->recordEmail(other->getId(), "Hi", "Hello"));
+    CHECK(custom.getLoyaltyBalance(after->getId()) == 4);
+    CHECK(standard.getLoyaltyBalance(other->getId()) == 10);
+}
+
+static void testLatencyHistogram() {
+    // Bucket bounds are contiguous and every value lands in the bucket that covers it
+    for (size_t bucket = 0; bucket + 1 < LatencyHistogram::kBucketCount; ++bucket) {
+        uint64_t lower = LatencyHistogram::bucketLowerBound(bucket);
+        CHECK(LatencyHistogram::bucketFor(lower) == bucket);
+        CHECK(LatencyHistogram::bucketFor(LatencyHistogram::bucketLowerBound(bucket + 1) - 1) == bucket);
+    }
+    CHECK(LatencyHistogram::bucketFor(UINT64_MAX) == LatencyHistogram::kBucketCount - 1);
+    
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 1000; ++value)
+        histogram.record(value);
+    CHECK(histogram.getCount() == 1000);
+    CHECK(histogram.getMax() == 1000);
+    CHECK(histogram.getTotal() == 500500);
+    uint64_t p50 = histogram.getPercentile(0.5);
+    uint64_t p99 = histogram.getPercentile(0.99);
+    CHECK(p50 >= 500 && p50 <= 500 * 17 / 16);
+    CHECK(p99 >= 990 && p99 <= 1000);
+    CHECK(histogram.getPercentile(1.0) == 1000);
+    
+    histogram.reset();
+    CHECK(histogram.getCount() == 0 && histogram.getPercentile(0.5) == 0);
+}
+
+static void testOperationMetrics() {
+    QuietOutput quiet;
+    Metrics& metrics = Metrics::instance();
+    metrics.reset();
+    CRM crm;
+    auto rep = crm.createSalesRepresentative("Alice Thompson");
+    auto customer = crm.createVIPCustomer("Jane Smith", "jane@example.com", "555-5678", "Michael Johnson");
+    crm.assignCustomerToRep(customer->getId(), rep->getId());
+    for (int i = 0; i < 10; ++i)
+        rep->recordCall(customer->getId(), "Follow-up call", 5);
+    
+    CHECK(metrics.getStats(Operation::RecordCall).count == 10);
+    CHECK(metrics.getStats(Operation::RecordCall).max >= metrics.getStats(Operation::RecordCall).p50);
+    CHECK(metrics.getStats(Operation::AssignCustomerToRep).count == 1);
+    CHECK(metrics.getStats(Operation::RecordEmail).count == 0);
+    CHECK(metrics.toText().find("SalesRepresentative::recordCall") != std::string::npos);
+    CHECK(metrics.toJson().find("{\"name\": \"SalesRepresentative::recordCall\", \"count\": 10") != std::string::npos);
+    CHECK(metrics.toJson().find("recordEmail") == std::string::npos);
+    
+    crm.getSalesRepresentative(rep->getId());
+    crm.getCustomers();
+    crm.getSalesRepresentatives();
+    crm.getAnnualContractValue();
+    crm.getAnnualContractValue(rep->getId());
+    std::ostringstream reports;
+    crm.generateInteractionTimeReports(reports);
+    CHECK(metrics.getStats(Operation::GetSalesRepresentative).count == 1);
+    CHECK(metrics.getStats(Operation::GetCustomers).count == 1);
+    CHECK(metrics.getStats(Operation::GetSalesRepresentatives).count == 1);
+    CHECK(metrics.getStats(Operation::GetAnnualContractValue).count == 2);
+    CHECK(metrics.getStats(Operation::GenerateInteractionTimeReports).count == 1);
+    
+    metrics.setEnabled(false);
+    rep->recordCall(customer->getId(), "Not timed", 5);
+    metrics.setEnabled(true);
+    CHECK(metrics.getStats(Operation::RecordCall).count == 10);
+}
+
+static void testCrmAssignmentAndReports() {
+    QuietOutput quiet;
+    CRM crm;
+    auto regular = crm.createRegularCustomer("John Doe", "john@example.com", "555-1234", "Small Business");
+    auto vip = crm.createVIPCustomer("Jane Smith", "jane@example.com", "555-5678", "Michael Johnson");
+    auto corporate = crm.createCorporateCustomer("Bob Anderson", "bob@megacorp.com", "555-9876",
+                                                 "MegaCorp", 1500, 50000.00);
+    auto alice = crm.createSalesRepresentative("Alice Thompson");
+    auto david = crm.createSalesRepresentative("David Wilson");
+    
+    crm.assignCustomerToRep(regular->getId(), alice->getId());
+    crm.assignCustomerToRep(vip->getId(), alice->getId());
+    crm.assignCustomerToRep(corporate->getId(), david->getId());
+    CHECK(alice->getCustomerCount() == 2);
+    CHECK(david->getCustomerCount() == 1);
+    CHECK(crm.getCustomer(vip->getId())->getRepId() == alice->getId());
+    CHECK(crm.getCustomer(999) == nullptr);
+    
+    alice->recordCall(regular->getId(), "Discussed new product features", 15);
+    alice->recordMeeting(vip->getId(), "Quarterly review meeting", "Headquarters", 60);
+    david->recordMeeting(corporate->getId(), "Contract renewal discussion", "Client's Office", 90);
+    
+    // Default rules: VIP time counts 1.2x, corporate with more than 1000 employees 1.5x
+    CHECK(vip->calculateTotalInteractionTime() == 72);
+    CHECK(corporate->calculateTotalInteractionTime() == 135);
+    auto top = crm.getTopCustomersByInteractionTime(2);
+    CHECK(top.size() == 2 && top[0] == corporate && top[1] == vip);
+    CHECK(crm.filterCustomers(CustomerKind::Regular, 10) == std::vector<int>{regular->getId()});
+    CHECK(crm.searchInteractions("renewal").size() == 1);
+    
+    crm.commitLoyaltyPoints();
+    CHECK(crm.getLoyaltyBalance(vip->getId()) == 120);
+    CHECK(vip->getLoyaltyPoints() == 120);
+    CHECK(crm.getTotalLoyaltyPoints() == 120);
+    
+    CHECK(crm.getAnnualContractValue() == 50000);
+    CHECK(crm.getAnnualContractValue(david->getId()) == 50000);
+    CHECK(crm.reassignCustomer(corporate->getId(), alice->getId()));
+    CHECK(crm.getAnnualContractValue(david->getId()) == 0);
+    CHECK(crm.getAnnualContractValue(alice->getId()) == 50000);
+    CHECK(crm.renewContracts({{corporate->getId(), 75000, 0}, {regular->getId(), 10, 0}}) == 1);
+    CHECK(crm.getAnnualContractValue() == 75000);
+    
+    int regularId = regular->getId();
+    CHECK(crm.removeCustomer(regularId));
+    CHECK(crm.getCustomer(regularId) == nullptr);
+    CHECK(alice->getCustomerCount() == 2);
+    CHECK(crm.searchInteractions("features").empty());
+    CHECK(!crm.removeCustomer(regularId));
+    CHECK(crm.countCustomersByAccountManager()["Michael Johnson"] == 1);
+}
+
+// Create regular customers for a rep, alternating two segments; customer i gets
+// one call of 10 * (i + 1) minutes
+static std::vector<int> addCustomersWithCalls(CRM& crm, SalesRepresentative* rep, int count,
+                                              const std::string& note) {
+    std::vector<int> ids;
+    for (int i = 0; i < count; ++i) {
+        auto customer = crm.createRegularCustomer("Customer " + std::to_string(i),
+                                                  "c" + std::to_string(i) + "@example.com", "555-0000",
+                                                  i % 2 ? "Retail" : "Small Business");
+        ids.push_back(customer->getId());
+        crm.assignCustomerToRep(customer->getId(), rep->getId());
+        rep->recordCall(customer->getId(), note, 10 * (i + 1));
+    }
+    return ids;
+}
+
+static void testTopCustomerRanking() {
+    QuietOutput quiet;
+    CRM crm;
+    auto rep = crm.createSalesRepresentative("Alice Thompson");
+    std::vector<int> ids = addCustomersWithCalls(crm, rep, 5, "Call");
+    auto top = crm.getTopCustomersByInteractionTime(3);
+    CHECK(top.size() == 3 && top[0]->getId() == ids[4] && top[1]->getId() == ids[3] && top[2]->getId() == ids[2]);
+    
+    // The ranking follows new interactions and drops removed customers
+    CHECK(crm.removeCustomer(ids[4]));
+    rep->recordCall(ids[0], "Call", 100);
+    top = crm.getTopCustomersByInteractionTime(10);
+    CHECK(top.size() == 4 && top[0]->getId() == ids[0] && top[1]->getId() == ids[3]);
+    CHECK(top[3]->getId() == ids[1]);
+    CHECK(crm.getTopCustomersByInteractionTime(0).empty());
+}
+
+static void testBulkReassignment() {
+    QuietOutput quiet;
+    CRM crm;
+    auto alice = crm.createSalesRepresentative("Alice Thompson");
+    auto david = crm.createSalesRepresentative("David Wilson");
+    std::vector<int> ids = addCustomersWithCalls(crm, alice, 4, "Call");
+    
+    // Bulk moves skip unknown customers and reps
+    CHECK(crm.reassignCustomers({{ids[0], david->getId()}, {999, david->getId()}, {ids[1], 999},
+                                 {ids[2], david->getId()}}) == 2);
+    CHECK(alice->getCustomerCount() == 2);
+    CHECK(david->getCustomerCount() == 2);
+    CHECK(crm.getCustomer(ids[0])->getRepId() == david->getId());
+    CHECK(crm.getCustomer(ids[1])->getRepId() == alice->getId());
+    
+    // Removal takes a customer out of its rep's portfolio in any position
+    CHECK(crm.removeCustomer(ids[0]));
+    CHECK(david->getCustomerCount() == 1 && david->getCustomers().size() == 1);
+    CHECK(crm.reassignCustomer(ids[2], alice->getId()));
+    CHECK(david->getCustomerCount() == 0 && alice->getCustomerCount() == 3);
+    CHECK(!crm.reassignCustomer(ids[0], alice->getId()));
+}
+
+static void testInternedSegmentCounts() {
+    QuietOutput quiet;
+    CRM crm;
+    auto rep = crm.createSalesRepresentative("Alice Thompson");
+    std::vector<int> ids = addCustomersWithCalls(crm, rep, 5, "Call");
+    auto first = static_cast<const RegularCustomer*>(crm.getCustomer(ids[0]));
+    auto third = static_cast<const RegularCustomer*>(crm.getCustomer(ids[2]));
+    CHECK(first->getSegmentId() == third->getSegmentId() && third->getSegment() == "Small Business");
+    
+    auto segments = crm.countCustomersBySegment();
+    CHECK(segments.size() == 2 && segments["Retail"] == 2 && segments["Small Business"] == 3);
+    CHECK(crm.removeCustomer(ids[4]));
+    segments = crm.countCustomersBySegment();
+    CHECK(segments["Retail"] == 2 && segments["Small Business"] == 2);
+    
+    crm.createVIPCustomer("Vera", "vera@example.com", "", "Michael Johnson");
+    crm.createVIPCustomer("Victor", "victor@example.com", "", "Michael Johnson");
+    CHECK(crm.countCustomersByAccountManager() == (std::map<std::string, int>{{"Michael Johnson", 2}}));
+}
+
+static void testInteractionCompression() {
+    QuietOutput quiet;
+    CRM crm;
+    auto rep = crm.createSalesRepresentative("Alice Thompson");
+    const std::string note = "Following up on our call regarding the contract renewal and pricing details";
+    std::vector<int> ids = addCustomersWithCalls(crm, rep, 3, note);
+    
+    // Only interactions older than the cutoff are compressed
+    CHECK(crm.compressInteractionsOlderThan(1) == 0);
+    CHECK(crm.compressInteractionsOlderThan(-1) > 0);
+    CHECK(crm.compressInteractionsOlderThan(-1) == 0);
+    
+    // Compressed content reads back unchanged and stays searchable
+    for (int id : ids) {
+        for (const auto& interaction : crm.getCustomer(id)->getInteractions())
+            CHECK(interaction->getContent() == note);
+    }
+    CHECK(crm.searchInteractions("pricing").size() == 3);
+}
+
+static void testInteractionIndexMaintenance() {
+    QuietOutput quiet;
+    CRM crm;
+    auto alice = crm.createSalesRepresentative("Alice Thompson");
+    auto david = crm.createSalesRepresentative("David Wilson");
+    std::vector<int> ids = addCustomersWithCalls(crm, alice, 4, "Discussed the renewal of the support plan");
+    CHECK(alice->recordEmail(ids[1], "Proposal attached", "Quarterly pricing"));
+    CHECK(crm.searchInteractions("renewal").size() == 4);
+    CHECK(crm.searchInteractions("quarterly pricing").size() == 1);
+    
+    // Hits follow a customer to its new rep and disappear when it is removed
+    CHECK(crm.reassignCustomer(ids[1], david->getId()));
+    CHECK(crm.searchInteractions("quarterly pricing").size() == 1);
+    CHECK(crm.removeCustomer(ids[1]));
+    CHECK(crm.searchInteractions("quarterly pricing").empty());
+    CHECK(crm.searchInteractions("renewal").size() == 3);
+}
+
+static void testAutoAssignBalancesLoad() {
+    QuietOutput quiet;
+    CRM crm;
+    auto first = crm.createSalesRepresentative("Rep One");
+    auto second = crm.createSalesRepresentative("Rep Two");
+    for (int i = 0; i < 6; ++i) {
+        auto customer = crm.createRegularCustomer("Customer " + std::to_string(i),
+                                                  "c" + std::to_string(i) + "@example.com", "", "Retail");
+        CHECK(crm.autoAssignCustomer(customer->getId()) != 0);
+    }
+    CHECK(first->getCustomerCount() == 3);
+    CHECK(second->getCustomerCount() == 3);
+    
+    crm.removeSalesRepresentative(first->getId());
+    CHECK(second->getCustomerCount() == 6);
+    
+    // Removing the only rep leaves its customers unassigned everywhere
+    int secondId = second->getId();
+    crm.removeSalesRepresentative(secondId);
+    CustomerHistory::Version version;
+    ReportSummary summary = crm.openReportSnapshot().summarize(0, true);
+    for (const Customer* customer : crm.getCustomers()) {
+        CHECK(customer->getRepId() == 0);
+        CHECK(crm.getCustomerAsOf(customer->getId(), time(nullptr) + 1, version) && version.repId == 0);
+    }
+    CHECK(summary.reps.empty());
+}
+
+static void testRebalanceKeepsBusyRepPortfolio() {
+    QuietOutput quiet;
+    CRM crm;
+    auto busy = crm.createSalesRepresentative("Busy Rep");
+    auto idle = crm.createSalesRepresentative("Quiet Rep");
+    for (int i = 0; i < 8; ++i) {
+        auto customer = crm.createRegularCustomer("Customer " + std::to_string(i),
+                                                  "c" + std::to_string(i) + "@example.com", "", "Retail");
+        auto rep = i < 4 ? busy : idle;
+        crm.assignCustomerToRep(customer->getId(), rep->getId());
+        if (rep == busy)
+            rep->recordCall(customer->getId(), "Long call", 600);
+    }
+    auto newcomer = crm.createSalesRepresentative("New Rep");
+    
+    // The busy rep's minutes do not move with its customers, so they must not drain its portfolio
+    CHECK(crm.rebalanceCustomers() == 2);
+    CHECK(busy->getCustomerCount() == 3);
+    CHECK(idle->getCustomerCount() == 3);
+    CHECK(newcomer->getCustomerCount() == 2);
+    CHECK(crm.rebalanceCustomers() == 0);
+}
+
+static void testInteractionTiering() {
+    QuietOutput quiet;
+    CRM crm;
+    auto rep = crm.createSalesRepresentative("Rep");
+    auto customer = crm.createRegularCustomer("Tia", "tia@example.com", "", "Retail");
+    crm.assignCustomerToRep(customer->getId(), rep->getId());
+    time_t old = time(nullptr) - 90 * 24 * 60 * 60;
+    customer->addInteraction(std::make_unique<Call>("Old call", 12, old));
+    customer->addInteraction(std::make_unique<Email>("Old email", "Renewal", old + 60));
+    customer->addInteraction(std::make_unique<Meeting>("Old meeting", "Office", 30, old + 120));
+    rep->recordCall(customer->getId(), "Recent call", 5);
+    
+    // Nothing is spilled before tiering is enabled
+    CHECK(crm.spillInteractionsOlderThan(30) == 0);
+    std::string path = "crm_tests_archive.seg";
+    CHECK(crm.enableInteractionTiering(path));
+    CHECK(!crm.enableInteractionTiering(path));
+    CHECK(crm.spillInteractionsOlderThan(30) == 3);
+    CHECK(customer->getArchivedInteractionCount() == 3 && customer->getInteractions().size() == 1);
+    CHECK(customer->calculateTotalInteractionTime() == 47);
+    
+    // Archived interactions read back intact, oldest first
+    std::vector<std::string> contents;
+    customer->forEachInteraction([&contents](const Interaction& interaction) {
+        contents.push_back(interaction.getContent() + "/" + std::to_string(interaction.getDuration()));
+    });
+    CHECK((contents == std::vector<std::string>{"Old call/12", "Old email/0", "Old meeting/30", "Recent call/5"}));
+    CHECK(crm.searchInteractions("renewal").size() == 1);
+    std::remove(path.c_str());
+
+#if defined(__linux__)
+    // A write that fails (here a full device) keeps the interactions in memory
+    CRM full;
+    auto other = full.createRegularCustomer("Uma", "uma@example.com", "", "Retail");
+    other->addInteraction(std::make_unique<Call>("Old call", 12, old));
+    CHECK(full.enableInteractionTiering("/dev/full"));
+    CHECK(full.spillInteractionsOlderThan(30) == 0);
+    CHECK(other->getArchivedInteractionCount() == 0 && other->getInteractions().size() == 1);
+#endif
+}
+
+static void testMemoryUsage() {
+    QuietOutput quiet;
+    CRM crm;
+    CRM::MemoryUsage empty = crm.getMemoryUsage();
+    auto rep = crm.createSalesRepresentative("Rep");
+    for (int i = 0; i < 50; ++i) {
+        auto customer = crm.createRegularCustomer("Customer " + std::to_string(i),
+                                                  "c" + std::to_string(i) + "@example.com", "", "Retail");
+        crm.assignCustomerToRep(customer->getId(), rep->getId());
+        rep->recordCall(customer->getId(), "Discussed the renewal of the support plan", 10);
+    }
+    CRM::MemoryUsage usage = crm.getMemoryUsage();
+    CHECK(usage.customers > empty.customers);
+    CHECK(usage.interactions >= 50 * sizeof(Call));
+    CHECK(usage.customerTable > empty.customerTable);
+    CHECK(usage.interactionIndex > empty.interactionIndex);
+    CHECK(usage.salesReps > empty.salesReps);
+    CHECK(usage.total() > empty.total());
+}
+
+static void testServiceProtocol() {
+    ServiceRequest request;
+    request.op = ServiceOp::RecordMeeting;
+    request.id = 7;
+    request.repId = 3;
+    request.customerId = 12;
+    request.content = "Contract review";
+    request.detail = "Head office";
+    request.minutes = 45;
+    
+    std::string frame;
+    encodeServiceRequest(request, frame);
+    CHECK(serviceFrameSize(frame.data(), frame.size()) == frame.size());
+    CHECK(serviceFrameSize(frame.data(), frame.size() - 1) == 0);
+    
+    ServiceRequest decoded;
+    CHECK(decodeServiceRequest(frame.data() + 4, frame.size() - 4, decoded));
+    CHECK(decoded.op == ServiceOp::RecordMeeting && decoded.id == 7);
+    CHECK(decoded.repId == 3 && decoded.customerId == 12 && decoded.minutes == 45);
+    CHECK(decoded.content == "Contract review" && decoded.detail == "Head office");
+    
+    // Truncated payloads and trailing bytes are rejected
+    CHECK(!decodeServiceRequest(frame.data() + 4, frame.size() - 5, decoded));
+    std::string padded = frame.substr(4) + "x";
+    CHECK(!decodeServiceRequest(padded.data(), padded.size(), decoded));
+    
+    std::string oversized(4, '\xff');
+    CHECK(serviceFrameSize(oversized.data(), oversized.size()) == SIZE_MAX);
+}
+
+static void testCrmService() {
+    CRM crm;
+    CrmService service(crm);
+    
+    // Pipeline several requests in one buffer, the last one split across reads
+    std::string input;
+    ServiceRequest request;
+    request.op = ServiceOp::CreateRep;
+    request.id = 1;
+    request.name = "Rep";
+    encodeServiceRequest(request, input);
+    
+    request = ServiceRequest();
+    request.op = ServiceOp::CreateCustomer;
+    request.id = 2;
+    request.kind = CustomerKind::Corporate;
+    request.name = "Acme Buyer";
+    request.email = "buyer@acme.com";
+    request.group = "Acme";
+    request.employees = 250;
+    request.annualContract = 1500.50;
+    encodeServiceRequest(request, input);
+    
+    request = ServiceRequest();
+    request.op = ServiceOp::Assign;
+    request.id = 3;
+    request.customerId = 1;
+    request.repId = 1;
+    encodeServiceRequest(request, input);
+    
+    request = ServiceRequest();
+    request.op = ServiceOp::RecordCall;
+    request.id = 4;
+    request.repId = 1;
+    request.customerId = 1;
+    request.content = "Pricing call";
+    request.minutes = 20;
+    encodeServiceRequest(request, input);
+    
+    request = ServiceRequest();
+    request.op = ServiceOp::RecordEmail;
+    request.id = 5;
+    request.repId = 1;
+    request.customerId = 99;
+    encodeServiceRequest(request, input);
+    
+    request = ServiceRequest();
+    request.op = ServiceOp::GetCustomer;
+    request.id = 6;
+    request.customerId = 1;
+    encodeServiceRequest(request, input);
+    
+    std::string output;
+    size_t consumed = service.handleFrames(input.data(), input.size() - 3, output);
+    CHECK(consumed < input.size());
+    consumed += service.handleFrames(input.data() + consumed, input.size() - consumed, output);
+    CHECK(consumed == input.size());
+    
+    std::vector<ServiceResponse> responses;
+    size_t offset = 0;
+    while (size_t frame = serviceFrameSize(output.data() + offset, output.size() - offset)) {
+        ServiceResponse response;
+        CHECK(decodeServiceResponse(output.data() + offset + 4, frame - 4, response));
+        responses.push_back(response);
+        offset += frame;
+    }
+    CHECK(responses.size() == 6);
+    if (responses.size() != 6)
+        return;
+    for (size_t i = 0; i < responses.size(); ++i)
+        CHECK(responses[i].id == i + 1);
+    CHECK(responses[0].value == 1 && responses[1].value == 1);
+    CHECK(responses[2].status == ServiceStatus::Ok && responses[3].status == ServiceStatus::Ok);
+    CHECK(responses[4].status == ServiceStatus::NotFound);
+    CHECK(responses[5].kind == CustomerKind::Corporate && responses[5].repId == 1);
+    CHECK(responses[5].minutes == static_cast<uint32_t>(crm.getCustomer(1)->calculateTotalInteractionTime()));
+    CHECK(responses[5].minutes >= 20 && responses[5].name == "Acme Buyer");
+    CHECK(crm.getAnnualContractValue(1) == 1500.50);
+}
+
+static void testBatchRequests() {
+    QuietOutput quiet;
+    CRM crm;
+    auto rep = crm.createSalesRepresentative("Rep");
+    auto other = crm.createSalesRepresentative("Other");
+    auto first = crm.createRegularCustomer("First", "first@example.com", "", "Retail");
+    auto second = crm.createVIPCustomer("Second", "second@example.com", "", "Manager");
+    crm.assignCustomerToRep(first->getId(), rep->getId());
+    crm.assignCustomerToRep(second->getId(), other->getId());
+    
+    // A batch mixing record runs for two reps, an unknown customer and a lookup
+    ServiceRequest batch;
+    batch.op = ServiceOp::Batch;
+    batch.id = 1;
+    auto record = [&batch](ServiceOp op, int repId, int customerId, uint32_t minutes) {
+        ServiceRequest item;
+        item.op = op;
+        item.id = static_cast<uint32_t>(batch.batch.size() + 1);
+        item.repId = static_cast<uint32_t>(repId);
+        item.customerId = static_cast<uint32_t>(customerId);
+        item.content = "Follow-up";
+        item.detail = "Office";
+        item.minutes = minutes;
+        batch.batch.push_back(item);
+    };
+    record(ServiceOp::RecordCall, rep->getId(), first->getId(), 10);
+    record(ServiceOp::RecordMeeting, rep->getId(), first->getId(), 30);
+    record(ServiceOp::RecordCall, other->getId(), second->getId(), 50);
+    record(ServiceOp::RecordEmail, other->getId(), first->getId(), 0);
+    record(ServiceOp::GetCustomer, 0, first->getId(), 0);
+    
+    std::string input;
+    encodeServiceRequest(batch, input);
+    std::string output;
+    CrmService service(crm);
+    CHECK(service.handleFrames(input.data(), input.size(), output) == input.size());
+    CHECK(serviceFrameSize(output.data(), output.size()) == output.size());
+    
+    ServiceResponse response;
+    CHECK(decodeServiceResponse(output.data() + 4, output.size() - 4, response));
+    CHECK(response.op == ServiceOp::Batch && response.status == ServiceStatus::Ok);
+    CHECK(response.batch.size() == 5);
+    if (response.batch.size() != 5)
+        return;
+    for (size_t i = 0; i < 5; ++i)
+        CHECK(response.batch[i].id == i + 1);
+    CHECK(response.batch[0].status == ServiceStatus::Ok && response.batch[2].status == ServiceStatus::Ok);
+    CHECK(response.batch[3].status == ServiceStatus::NotFound);
+    CHECK(response.batch[4].minutes == 40);
+    
+    // Deferred ranking ends up the same as recording one at a time
+    CHECK(first->getInteractionCount() == 2);
+    auto top = crm.getTopCustomersByInteractionTime(2);
+    CHECK(top.size() == 2 && top[0] == second && top[1] == first);
+    CHECK(crm.getCustomer(second->getId())->calculateTotalInteractionTime() >= 50);
+    
+    // Nested batches are rejected
+    ServiceRequest nested;
+    nested.op = ServiceOp::Batch;
+    nested.batch.push_back(batch);
+    input.clear();
+    encodeServiceRequest(nested, input);
+    ServiceRequest decoded;
+    CHECK(!decodeServiceRequest(input.data() + 4, input.size() - 4, decoded));
+}
+
+static void testReplicationLog() {
+    ReplicationLog log(1000);
+    CHECK(log.getNextSequence() == 1 && log.canResumeFrom(1) && !log.canResumeFrom(2));
+    
+    ServiceRequest request;
+    request.op = ServiceOp::CreateRep;
+    request.name = std::string(40, 'r');
+    std::string frame;
+    encodeServiceRequest(request, frame);
+    for (int i = 0; i < 3; ++i)
+        log.append(request);
+    CHECK(log.getNextSequence() == 4 && log.getSize() == 3 * frame.size());
+    
+    // Copies are whole frames, at least one even when it exceeds the limit
+    std::string out;
+    CHECK(log.copyFrom(2, out) == 4 && out == frame + frame);
+    out.clear();
+    CHECK(log.copyFrom(1, out, 1) == 2 && out == frame);
+    out.clear();
+    CHECK(log.copyFrom(4, out) == 4 && out.empty());
+    
+    // Past the capacity the oldest entries go, and resuming from them fails
+    for (int i = 0; i < 30; ++i)
+        log.append(request);
+    CHECK(log.getNextSequence() == 34);
+    CHECK(log.getFirstSequence() > 1 && log.getSize() <= 1000);
+    CHECK(!log.canResumeFrom(1) && log.canResumeFrom(log.getFirstSequence()));
+    out.clear();
+    CHECK(log.copyFrom(log.getFirstSequence(), out) == 34 && out.size() == log.getSize());
+}
+
+// Drive a CRM through the service with a mix of customers, reps and interactions
+static void populateThroughService(CrmService& service, int customers) {
+    std::string input;
+    ServiceRequest request;
+    for (const char* name : {"Alice", "Bob", "Carol"}) {
+        request.op = ServiceOp::CreateRep;
+        request.name = name;
+        encodeServiceRequest(request, input);
+    }
+    for (int i = 1; i <= customers; ++i) {
+        request = ServiceRequest();
+        request.op = ServiceOp::CreateCustomer;
+        request.kind = static_cast<CustomerKind>(i % 3);
+        request.name = "Customer " + std::to_string(i);
+        request.email = "c" + std::to_string(i) + "@example.com";
+        request.group = i % 2 ? "North" : "South";
+        request.employees = static_cast<uint32_t>(i * 10);
+        request.annualContract = 1000.0 * i;
+        encodeServiceRequest(request, input);
+        
+        // Leave every fifth customer unassigned and move every seventh
+        if (i % 5 != 0) {
+            request.op = ServiceOp::Assign;
+            request.customerId = static_cast<uint32_t>(i);
+            request.repId = static_cast<uint32_t>(i % 3 + 1);
+            encodeServiceRequest(request, input);
+            for (ServiceOp op : {ServiceOp::RecordCall, ServiceOp::RecordEmail, ServiceOp::RecordMeeting}) {
+                request.op = op;
+                request.content = "Talk " + std::to_string(i);
+                request.detail = "Room " + std::to_string(i % 4);
+                request.minutes = static_cast<uint32_t>(5 + i % 40);
+                encodeServiceRequest(request, input);
+            }
+            if (i % 7 == 0) {
+                request.op = ServiceOp::Assign;
+                request.repId = request.repId % 3 + 1;
+                encodeServiceRequest(request, input);
+            }
+        }
+    }
+    std::string output;
+    service.handleFrames(input.data(), input.size(), output);
+}
+
+static std::string allReports(CRM& crm) {
+    std::ostringstream out;
+    crm.generateSystemReport(out);
+    crm.generateRevenueReport(out);
+    crm.generateInteractionTimeReports(out);
+    crm.displayTopCustomers(10, out);
+    return out.str();
+}
+
+static void testSnapshotReplay() {
+    QuietOutput quiet;
+    CRM primary;
+    CrmService primaryService(primary);
+    ReplicationLog log;
+    primaryService.setReplicationLog(&log);
+    populateThroughService(primaryService, 40);
+    CHECK(log.getNextSequence() > 1);
+    
+    // Replaying the snapshot rebuilds the same state
+    std::string snapshot;
+    uint32_t frames = primaryService.writeSnapshot(snapshot);
+    CHECK(frames > 40);
+    CRM replica;
+    CrmService replicaService(replica);
+    std::string output;
+    CHECK(replicaService.handleFrames(snapshot.data(), snapshot.size(), output) == snapshot.size());
+    CHECK(allReports(replica) == allReports(primary));
+    
+    // So does replaying the log from the start
+    CRM replayed;
+    CrmService replayedService(replayed);
+    std::string entries;
+    log.copyFrom(1, entries);
+    replayedService.handleFrames(entries.data(), entries.size(), output);
+    CHECK(allReports(replayed) == allReports(primary));
+    
+    // A read-only service refuses mutations but still answers reads
+    replicaService.setReadOnly(true);
+    ServiceRequest request;
+    ServiceResponse response;
+    request.op = ServiceOp::CreateRep;
+    request.name = "Dave";
+    replicaService.execute(request, response);
+    CHECK(response.status == ServiceStatus::ReadOnly);
+    ServiceRequest batch;
+    batch.op = ServiceOp::Batch;
+    batch.batch.assign(1, request);
+    replicaService.execute(batch, response);
+    CHECK(response.batch.size() == 1 && response.batch[0].status == ServiceStatus::ReadOnly);
+    request = ServiceRequest();
+    request.op = ServiceOp::GetCustomer;
+    request.customerId = 1;
+    replicaService.execute(request, response);
+    CHECK(response.status == ServiceStatus::Ok && response.name == "Customer 1");
+}
+
+static void testReportSummaryMerge() {
+    QuietOutput quiet;
+    CRM whole;
+    CRM shards[2];
+    CHECK(shards[0].setCustomerIdSpace(1, 2) && shards[1].setCustomerIdSpace(2, 2));
+    CHECK(!shards[1].setCustomerIdSpace(1, 1));
+    
+    // The same reps everywhere; customers split between the two shards
+    for (CRM* crm : {&whole, &shards[0], &shards[1]}) {
+        crm->createSalesRepresentative("Alice");
+        crm->createSalesRepresentative("Bob");
+    }
+    for (int i = 1; i <= 10; ++i) {
+        CRM& shard = shards[i % 2];
+        for (CRM* crm : {&whole, &shard}) {
+            std::string name = "Customer " + std::to_string(i);
+            const Customer* customer = i % 3 == 0 
+                ? crm->createCorporateCustomer(name, "", "", "Acme", 10, 100.25 * i)
+                : static_cast<const Customer*>(crm->createVIPCustomer(name, "", "", "Manager"));
+            crm->assignCustomerToRep(customer->getId(), i % 2 + 1);
+            crm->getSalesRepresentative(i % 2 + 1)->recordCall(customer->getId(), "Call", i * 7);
+        }
+    }
+    
+    ReportSummary merged;
+    merged.merge(shards[0].getReportSummary(3, true), 3);
+    merged.merge(shards[1].getReportSummary(3, true), 3);
+    std::ostringstream expected, actual;
+    whole.generateSystemReport(expected);
+    whole.generateRevenueReport(expected);
+    whole.displayTopCustomers(3, expected);
+    merged.writeSystemReport(actual);
+    merged.writeRevenueReport(actual);
+    merged.writeTopCustomers(3, actual);
+    CHECK(actual.str() == expected.str());
+    CHECK(merged.reps.size() == 2 && merged.reps[0].customers.size() + merged.reps[1].customers.size() == 10);
+    CHECK(shards[1].getCustomers().front()->getId() == 2);
+    
+    // Summaries survive the wire
+    ServiceResponse response;
+    response.op = ServiceOp::Summary;
+    response.summary = merged;
+    std::string frame;
+    encodeServiceResponse(response, frame);
+    ServiceResponse decoded;
+    CHECK(decodeServiceResponse(frame.data() + 4, frame.size() - 4, decoded));
+    std::ostringstream roundTrip;
+    decoded.summary.writeSystemReport(roundTrip);
+    decoded.summary.writeRevenueReport(roundTrip);
+    decoded.summary.writeTopCustomers(3, roundTrip);
+    CHECK(roundTrip.str() == expected.str());
+}
+
+static std::string summaryReports(const ReportSummary& summary) {
+    std::ostringstream out;
+    summary.writeSystemReport(out);
+    summary.writeRevenueReport(out);
+    summary.writeTopCustomers(5, out);
+    return out.str();
+}
+
+static void testReportSnapshots() {
+    QuietOutput quiet;
+    CRM crm;
+    auto rep = crm.createSalesRepresentative("Rep");
+    for (int i = 1; i <= 600; ++i) {
+        std::string name = "Customer " + std::to_string(i);
+        const Customer* customer = i % 2 
+            ? static_cast<const Customer*>(crm.createRegularCustomer(name, "", "", "Retail"))
+            : crm.createCorporateCustomer(name, "", "", "Acme", 10, 10.0 * i);
+        crm.assignCustomerToRep(customer->getId(), rep->getId());
+        rep->recordCall(customer->getId(), "Call", i % 50);
+    }
+    
+    // A snapshot matches the live figures and keeps them through later writes
+    ReportVersions::Snapshot first = crm.openReportSnapshot();
+    std::string before = summaryReports(crm.getReportSummary(5, false));
+    CHECK(summaryReports(first.summarize(5, false)) == before);
+    
+    auto other = crm.createSalesRepresentative("Other");
+    crm.reassignCustomer(2, other->getId());
+    rep->recordCall(599, "Long call", 500);
+    crm.removeCustomer(300);
+    crm.createVIPCustomer("Late", "", "", "Manager");
+    CHECK(first.getCustomerCount() == 600);
+    CHECK(summaryReports(first.summarize(5, false)) == before);
+    CHECK(crm.getMemoryUsage().reportVersions > 0);
+    
+    // The chunks written while the snapshot was open were copied; the old
+    // versions are freed once no snapshot can see them
+    ReportVersions::Snapshot second = crm.openReportSnapshot();
+    CHECK(second.getEpoch() > first.getEpoch());
+    CHECK(summaryReports(second.summarize(5, false)) == summaryReports(crm.getReportSummary(5, false)));
+    ReportSummary withCustomers = second.summarize(0, true);
+    CHECK(withCustomers.reps.size() == 2 && withCustomers.reps[1].customers.size() == 1);
+    size_t pinnedMemory = crm.getMemoryUsage().reportVersions;
+    first.release();
+    CHECK(crm.getMemoryUsage().reportVersions < pinnedMemory);
+    
+    ReportVersions::Snapshot moved = std::move(second);
+    CHECK(moved.getCustomerCount() == 600 && second.getCustomerCount() == 0);
+    moved.release();
+    
+    // Readers outside the lock never see half of a locked update
+    auto minutesOf = [](const ReportSummary& summary, int customerId) {
+        for (const auto& customer : summary.reps[0].customers)
+            if (customer.id == customerId)
+                return customer.minutes;
+        return -1;
+    };
+    ReportSummary start = crm.getReportSummary(0, true);
+    int gap = minutesOf(start, 599) - minutesOf(start, 1);
+    std::mutex crmMutex;
+    bool torn = false;
+    std::thread reader([&] {
+        for (int i = 0; i < 200; ++i) {
+            ReportVersions::Snapshot snapshot;
+            {
+                std::lock_guard<std::mutex> lock(crmMutex);
+                snapshot = crm.openReportSnapshot();
+            }
+            ReportSummary summary = snapshot.summarize(0, true);
+            torn = torn || minutesOf(summary, 599) - minutesOf(summary, 1) != gap;
+        }
+    });
+    for (int i = 0; i < 2000; ++i) {
+        std::lock_guard<std::mutex> lock(crmMutex);
+        rep->recordCall(1, "Call", 3);
+        rep->recordCall(599, "Call", 3);
+    }
+    reader.join();
+    CHECK(!torn);
+}
+
+static void testReportsMatchLivePortfolios() {
+    QuietOutput quiet;
+    CRM crm;
+    auto first = crm.createSalesRepresentative("First");
+    auto second = crm.createSalesRepresentative("Second");
+    std::vector<int> ids = addCustomersWithCalls(crm, first, 12, "Call");
+    for (int i = 0; i < 4; ++i)
+        crm.createCorporateCustomer("Corp " + std::to_string(i), "", "", "Acme", 10, 1000.0 * (i + 1));
+    for (const Customer* customer : crm.getCustomers())
+        if (customer->getRepId() == 0)
+            crm.assignCustomerToRep(customer->getId(), second->getId());
+    
+    // Swap-removes reorder the portfolios away from table order
+    crm.reassignCustomer(ids[0], second->getId());
+    crm.unassignCustomer(ids[3]);
+    crm.removeCustomer(ids[5]);
+    crm.assignCustomerToRep(ids[3], first->getId());
+    crm.reassignCustomer(ids[11], second->getId());
+    
+    // The printed reports come from a snapshot and match the live state
+    std::ostringstream live;
+    for (const SalesRepresentative* rep : crm.getSalesRepresentatives())
+        rep->generateInteractionTimeReport(live);
+    ReportSummary summary = crm.getReportSummary(0, false);
+    summary.writeSystemReport(live);
+    summary.writeRevenueReport(live);
+    
+    std::ostringstream printed;
+    crm.generateInteractionTimeReports(printed);
+    crm.generateSystemReport(printed);
+    crm.generateRevenueReport(printed);
+    CHECK(printed.str() == live.str());
+    CHECK(live.str().find("Corp 3") != std::string::npos);
+}
+
+static void testCustomerHistory() {
+    QuietOutput quiet;
+    CRM crm;
+    time_t now = 1000;
+    crm.setHistoryClock([&now] { return now; });
+    auto first = crm.createSalesRepresentative("First");
+    auto second = crm.createSalesRepresentative("Second");
+    auto vip = crm.createVIPCustomer("Vera", "", "", "Manager");
+    auto corporate = crm.createCorporateCustomer("Cora", "", "", "Acme", 10, 50000);
+    crm.assignCustomerToRep(vip->getId(), first->getId());
+    crm.assignCustomerToRep(corporate->getId(), first->getId());
+    
+    now = 2000;
+    crm.reassignCustomer(vip->getId(), second->getId());
+    crm.addLoyaltyPoints(vip->getId(), 25);
+    crm.commitLoyaltyPoints();
+    crm.renewContracts({{corporate->getId(), 75000, 0}});
+    
+    // Several updates within one second leave a single version
+    now = 3000;
+    crm.addLoyaltyPoints(vip->getId(), 5);
+    crm.commitLoyaltyPoints();
+    crm.addLoyaltyPoints(vip->getId(), 5);
+    crm.commitLoyaltyPoints();
+    crm.removeCustomer(corporate->getId());
+    
+    CustomerHistory::Version version;
+    CHECK(!crm.getCustomerAsOf(vip->getId(), 999, version));
+    CHECK(crm.getCustomerAsOf(vip->getId(), 1500, version));
+    CHECK(version.repId == first->getId() && version.loyaltyPoints == 0);
+    CHECK(crm.getCustomerAsOf(vip->getId(), 2999, version));
+    CHECK(version.repId == second->getId() && version.loyaltyPoints == 25);
+    CHECK(crm.getCustomerAsOf(vip->getId(), 3000, version));
+    CHECK(version.loyaltyPoints == 35);
+    
+    // Removed customers can still be audited up to their removal
+    CHECK(crm.getCustomerAsOf(corporate->getId(), 1000, version));
+    CHECK(version.annualContract == 50000 && version.repId == first->getId());
+    CHECK(crm.getCustomerAsOf(corporate->getId(), 2500, version) && version.annualContract == 75000);
+    CHECK(!crm.getCustomerAsOf(corporate->getId(), 3000, version));
+    CHECK(!crm.getCustomerAsOf(999, 2000, version));
+    CHECK(crm.getMemoryUsage().customerHistory > 0);
+    
+    // Restoring the previous value within the same second drops the version
+    CustomerHistory history;
+    history.addCustomer(1, 10);
+    history.record(1, CustomerHistory::Field::RepId, 4, 10);
+    history.record(1, CustomerHistory::Field::RepId, 5, 20);
+    history.record(1, CustomerHistory::Field::RepId, 4, 20);
+    history.record(1, CustomerHistory::Field::RepId, 4, 30);
+    CHECK(history.getChangeCount() == 1);
+    CHECK(history.getVersion(1, 25, version) && version.repId == 4);
+}
+
+#if defined(CRM_HAS_SERVER)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "crm/crm_client.h"
+#include "crm/crm_server.h"
+#include "crm/replica_follower.h"
+#include "crm/shard_router.h"
+
+static void testCrmServer() {
+    CRM crm;
+    std::mutex crmMutex;
+    CrmServer server(crm, crmMutex);
+    CHECK(server.start("127.0.0.1", 0));
+    CHECK(server.getPort() != 0);
+    
+    CrmClient client;
+    CHECK(client.connect("127.0.0.1", server.getPort()));
+    ServiceRequest request;
+    request.op = ServiceOp::CreateCustomer;
+    request.kind = CustomerKind::VIP;
+    request.name = "Dana";
+    request.email = "dana@example.com";
+    request.group = "Manager";
+    
+    // Pipeline a batch of creates and read the responses back in order
+    for (int i = 0; i < 100; ++i)
+        client.send(request);
+    ServiceResponse response;
+    bool inOrder = true;
+    for (uint32_t i = 1; i <= 100; ++i) {
+        CHECK(client.receive(response));
+        inOrder = inOrder && response.id == i && response.value == i;
+    }
+    CHECK(inOrder);
+    
+    request = ServiceRequest();
+    request.op = ServiceOp::Report;
+    request.report = ServiceReport::System;
+    CHECK(client.call(request, response));
+    CHECK(response.text.find("VIP Customers: 100") != std::string::npos);
+    CHECK(server.getConnectionCount() == 1);
+    
+    client.close();
+    server.stop();
+    CHECK(!server.isRunning());
+}
+
+// Wait up to a few seconds for the follower to reach the end of the log
+static bool waitForReplica(const ReplicaFollower& follower, const ReplicationLog& log, std::mutex& crmMutex) {
+    for (int i = 0; i < 500; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(crmMutex);
+            if (follower.getNextSequence() == log.getNextSequence())
+                return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+static void testReadReplica() {
+    QuietOutput quiet;
+    CRM primary;
+    std::mutex primaryMutex;
+    ReplicationLog log;
+    CrmServer primaryServer(primary, primaryMutex);
+    primaryServer.setReplicationLog(&log);
+    CHECK(primaryServer.start("127.0.0.1", 0));
+    
+    // State from before the replica starts arrives in the snapshot
+    CrmClient client;
+    CHECK(client.connect("127.0.0.1", primaryServer.getPort()));
+    ServiceRequest request;
+    ServiceResponse response;
+    request.op = ServiceOp::CreateRep;
+    request.name = "Rep";
+    CHECK(client.call(request, response) && response.value == 1);
+    request.op = ServiceOp::CreateCustomer;
+    request.kind = CustomerKind::VIP;
+    request.name = "Early";
+    request.group = "Manager";
+    CHECK(client.call(request, response) && response.value == 1);
+    
+    CRM replica;
+    std::mutex replicaMutex;
+    ReplicaFollower follower(replica, replicaMutex);
+    CHECK(follower.start("127.0.0.1", primaryServer.getPort()));
+    CHECK(waitForReplica(follower, log, primaryMutex));
+    
+    // Later mutations are shipped from the log
+    request.name = "Late";
+    CHECK(client.call(request, response) && response.value == 2);
+    request.op = ServiceOp::Assign;
+    request.customerId = 2;
+    request.repId = 1;
+    CHECK(client.call(request, response) && response.status == ServiceStatus::Ok);
+    request.op = ServiceOp::RecordCall;
+    request.content = "Renewal";
+    request.minutes = 25;
+    CHECK(client.call(request, response) && response.status == ServiceStatus::Ok);
+    CHECK(waitForReplica(follower, log, primaryMutex));
+    {
+        std::lock_guard<std::mutex> primaryLock(primaryMutex);
+        std::lock_guard<std::mutex> replicaLock(replicaMutex);
+        CHECK(allReports(replica) == allReports(primary));
+        CHECK(replica.getCustomer(2) && replica.getCustomer(2)->getInteractionCount() == 1);
+    }
+    
+    // The replica's own server only serves reads
+    CrmServer replicaServer(replica, replicaMutex);
+    replicaServer.setReadOnly(true);
+    CHECK(replicaServer.start("127.0.0.1", 0));
+    CrmClient reader;
+    CHECK(reader.connect("127.0.0.1", replicaServer.getPort()));
+    CHECK(reader.call(request, response) && response.status == ServiceStatus::ReadOnly);
+    request = ServiceRequest();
+    request.op = ServiceOp::GetCustomer;
+    request.customerId = 2;
+    CHECK(reader.call(request, response) && response.status == ServiceStatus::Ok && response.name == "Late");
+    
+    follower.stop();
+    CHECK(!follower.isRunning());
+    replicaServer.stop();
+    primaryServer.stop();
+}
+
+static void testReplicaPartialSnapshot() {
+    // A fake primary that announces a three-frame snapshot, sends one frame and
+    // then a malformed one
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    CHECK(::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    CHECK(::listen(listener, 4) == 0);
+    CHECK(::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) == 0);
+    
+    std::atomic<bool> done{false};
+    std::thread primary([listener, &done] {
+        int fd = ::accept(listener, nullptr, nullptr);
+        char buffer[256];
+        ::recv(fd, buffer, sizeof(buffer), 0);
+        ServiceResponse subscribed;
+        subscribed.op = ServiceOp::Subscribe;
+        subscribed.value = 3;
+        subscribed.sequence = 10;
+        ServiceRequest rep;
+        rep.op = ServiceOp::CreateRep;
+        rep.name = "Rep";
+        std::string frames;
+        encodeServiceResponse(subscribed, frames);
+        encodeServiceRequest(rep, frames);
+        ::send(fd, frames.data(), frames.size(), MSG_NOSIGNAL);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        
+        frames.clear();
+        encodeServiceRequest(rep, frames);
+        frames[4] = 0x7F;  // no such op
+        ::send(fd, frames.data(), frames.size(), MSG_NOSIGNAL);
+        while (!done)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ::close(fd);
+    });
+    
+    // The replica gives up instead of reloading a snapshot on top of the partial one
+    CRM replica;
+    std::mutex replicaMutex;
+    ReplicaFollower follower(replica, replicaMutex);
+    CHECK(follower.start("127.0.0.1", ntohs(address.sin_port)));
+    for (int i = 0; i < 200 && follower.isRunning(); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(!follower.isRunning());
+    {
+        std::lock_guard<std::mutex> lock(replicaMutex);
+        CHECK(replica.getSalesRepresentatives().size() == 1);
+    }
+    done = true;
+    primary.join();
+    follower.stop();
+    ::close(listener);
+}
+
+static void testShardRouter() {
+    QuietOutput quiet;
+    const size_t kShards = 3;
+    CRM shards[kShards];
+    std::mutex shardMutexes[kShards];
+    std::vector<std::unique_ptr<CrmServer>> servers;
+    std::vector<std::pair<std::string, uint16_t>> addresses;
+    for (size_t i = 0; i < kShards; ++i) {
+        shards[i].setCustomerIdSpace(static_cast<int>(i) + 1, kShards);
+        servers.push_back(std::make_unique<CrmServer>(shards[i], shardMutexes[i]));
+        CHECK(servers.back()->start("127.0.0.1", 0));
+        addresses.emplace_back("127.0.0.1", servers.back()->getPort());
+    }
+    ShardRouter router(addresses);
+    std::mutex routerMutex;
+    CrmServer front(router, routerMutex);
+    CHECK(front.start("127.0.0.1", 0));
+    
+    // The same requests through the router and against one CRM
+    CRM whole;
+    CrmClient client;
+    CHECK(client.connect("127.0.0.1", front.getPort()));
+    ServiceRequest request;
+    ServiceResponse response;
+    for (const char* name : {"Alice", "Bob"}) {
+        request.op = ServiceOp::CreateRep;
+        request.name = name;
+        CHECK(client.call(request, response) && response.status == ServiceStatus::Ok);
+        CHECK(response.value == static_cast<uint32_t>(whole.createSalesRepresentative(name)->getId()));
+    }
+    
+    ServiceRequest batch;
+    batch.op = ServiceOp::Batch;
+    for (int i = 1; i <= 30; ++i) {
+        request = ServiceRequest();
+        request.op = ServiceOp::CreateCustomer;
+        request.kind = CustomerKind::Corporate;
+        request.name = "Customer " + std::to_string(i);
+        request.email = "c" + std::to_string(i) + "@example.com";
+        request.group = "Acme";
+        request.employees = 10;
+        request.annualContract = 250.5 * i;
+        batch.batch.push_back(request);
+    }
+    CHECK(client.call(batch, response) && response.batch.size() == 30);
+    std::vector<uint32_t> ids;
+    for (const auto& item : response.batch)
+        ids.push_back(item.value);
+    CHECK(ids.size() == 30 && ids[0] != 0);
+    
+    batch.batch.clear();
+    for (int i = 1; i <= 30; ++i) {
+        auto customer = whole.createCorporateCustomer("Customer " + std::to_string(i), "", "", "Acme", 10, 250.5 * i);
+        int repId = i % 2 + 1;
+        whole.assignCustomerToRep(customer->getId(), repId);
+        whole.getSalesRepresentative(repId)->recordCall(customer->getId(), "Call", i * 3);
+        
+        request = ServiceRequest();
+        request.op = ServiceOp::Assign;
+        request.customerId = ids[i - 1];
+        request.repId = static_cast<uint32_t>(repId);
+        batch.batch.push_back(request);
+        request.op = ServiceOp::RecordCall;
+        request.content = "Call";
+        request.minutes = static_cast<uint32_t>(i * 3);
+        batch.batch.push_back(request);
+    }
+    CHECK(client.call(batch, response) && response.batch.size() == 60);
+    bool allOk = true;
+    for (const auto& item : response.batch)
+        allOk = allOk && item.status == ServiceStatus::Ok;
+    CHECK(allOk);
+    
+    // Customers were spread over every shard
+    for (const CRM& shard : shards)
+        CHECK(!shard.getCustomers().empty());
+    
+    // Per-customer requests reach the right shard; reports add up across shards
+    request = ServiceRequest();
+    request.op = ServiceOp::GetCustomer;
+    request.customerId = ids[4];
+    CHECK(client.call(request, response) && response.status == ServiceStatus::Ok && response.name == "Customer 5");
+    request.op = ServiceOp::Report;
+    std::ostringstream expected;
+    for (ServiceReport report : {ServiceReport::System, ServiceReport::Revenue, ServiceReport::Top}) {
+        request.report = report;
+        request.count = 5;
+        CHECK(client.call(request, response) && response.status == ServiceStatus::Ok);
+        expected.str("");
+        if (report == ServiceReport::System)
+            whole.generateSystemReport(expected);
+        else if (report == ServiceReport::Revenue)
+            whole.generateRevenueReport(expected);
+        else
+            whole.displayTopCustomers(5, expected);
+        CHECK(response.text == expected.str());
+    }
+    request.report = ServiceReport::Reps;
+    CHECK(client.call(request, response) && response.text.find("Customer 30 (Corporate)") != std::string::npos);
+    
+    // A shard that goes away makes its requests Unavailable
+    servers[1]->stop();
+    request = ServiceRequest();
+    request.op = ServiceOp::GetCustomer;
+    request.customerId = 2;
+    CHECK(client.call(request, response) && response.status == ServiceStatus::Unavailable);
+    request.customerId = 1;
+    CHECK(client.call(request, response) && response.status == ServiceStatus::Ok);
+    
+    // CreateRep is not sent to any shard while one of them is unreachable
+    request = ServiceRequest();
+    request.op = ServiceOp::CreateRep;
+    request.name = "Carol";
+    CHECK(client.call(request, response) && response.status == ServiceStatus::Unavailable);
+    CHECK(shards[0].getSalesRepresentatives().size() == 2 && shards[2].getSalesRepresentatives().size() == 2);
+    CHECK(!router.haveRepIdsDiverged());
+    
+    front.stop();
+    for (auto& server : servers)
+        server->stop();
+    
+    // A rep created on only some shards makes every request naming a rep Unavailable
+    CRM partial[2];
+    std::mutex partialMutexes[2];
+    CrmServer writable(partial[0], partialMutexes[0]);
+    CrmServer readOnly(partial[1], partialMutexes[1]);
+    readOnly.setReadOnly(true);
+    CHECK(writable.start("127.0.0.1", 0) && readOnly.start("127.0.0.1", 0));
+    ShardRouter split({{"127.0.0.1", writable.getPort()}, {"127.0.0.1", readOnly.getPort()}});
+    std::string output;
+    std::string frames;
+    encodeServiceRequest(request, frames);
+    CHECK(split.handleFrames(frames.data(), frames.size(), output, nullptr) == frames.size());
+    CHECK(decodeServiceResponse(output.data() + 4, output.size() - 4, response));
+    CHECK(response.status == ServiceStatus::Unavailable && split.haveRepIdsDiverged());
+    CHECK(partial[0].getSalesRepresentatives().size() == 1);
+    
+    request.op = ServiceOp::Assign;
+    request.customerId = 1;
+    request.repId = 1;
+    frames.clear();
+    output.clear();
+    encodeServiceRequest(request, frames);
+    split.handleFrames(frames.data(), frames.size(), output, nullptr);
+    CHECK(decodeServiceResponse(output.data() + 4, output.size() - 4, response));
+    CHECK(response.status == ServiceStatus::Unavailable);
+    writable.stop();
+    readOnly.stop();
+    
+    // A shard that accepts connections but never answers times out instead of stalling the router
+    int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    CHECK(::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    CHECK(::listen(listener, 4) == 0);
+    CHECK(::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) == 0);
+    ShardRouter stalled({{"127.0.0.1", ntohs(address.sin_port)}}, 100);
+    request = ServiceRequest();
+    request.op = ServiceOp::GetCustomer;
+    request.customerId = 1;
+    frames.clear();
+    output.clear();
+    encodeServiceRequest(request, frames);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(stalled.handleFrames(frames.data(), frames.size(), output, nullptr) == frames.size());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    CHECK(decodeServiceResponse(output.data() + 4, output.size() - 4, response));
+    CHECK(response.status == ServiceStatus::Unavailable);
+    CHECK(seconds >= 0.09 && seconds < 1.0);
+    ::close(listener);
+}
+#endif
+
+#if defined(CRM_HAS_ADMIN_SERVER)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+
+// Send one command to an admin socket and read the whole response
+static std::string sendAdminCommand(const std::string& path, const std::string& command) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    std::string response;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        std::string line = command + "\n";
+        ::send(fd, line.data(), line.size(), 0);
+        char buffer[512];
+        ssize_t n;
+        while ((n = ::recv(fd, buffer, sizeof(buffer), 0)) > 0)
+            response.append(buffer, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return response;
+}
+
+static void testAdminServer() {
+    QuietOutput quiet;
+    CRM crm;
+    std::mutex crmMutex;
+    auto rep = crm.createSalesRepresentative("Rep");
+    auto regular = crm.createRegularCustomer("Ann", "ann@example.com", "", "Retail");
+    auto vip = crm.createVIPCustomer("Ben", "ben@example.com", "", "Manager");
+    crm.assignCustomerToRep(regular->getId(), rep->getId());
+    crm.assignCustomerToRep(vip->getId(), rep->getId());
+    rep->recordMeeting(vip->getId(), "Quarterly review", "Office", 45);
+    
+    AdminServer server(crm, crmMutex);
+    CHECK(server.handleCommand("counts json") == "{\"Regular\": 1, \"VIP\": 1}\n");
+    CHECK(server.handleCommand("counts").find("VIP: 1") != std::string::npos);
+    CHECK(server.handleCommand("memory json").find("\"total\": ") != std::string::npos);
+    CHECK(server.handleCommand("report top 1").find("1. Ben (VIP)") != std::string::npos);
+    CHECK(server.handleCommand("report system").find("Total Customers: 2") != std::string::npos);
+    CHECK(server.handleCommand("report top x").rfind("error:", 0) == 0);
+    for (const char* count : {"-1", "+1", "1x", "99999999999999999999999"})
+        CHECK(server.handleCommand(std::string("report top ") + count).rfind("error:", 0) == 0);
+    CHECK(server.handleCommand("frobnicate").rfind("error:", 0) == 0);
+    CHECK(server.handleCommand("metrics json").find("CRM::createVIPCustomer") != std::string::npos);
+    
+    std::string path = "/tmp/crm_tests_admin_" + std::to_string(::getpid()) + ".sock";
+    CHECK(server.start(path));
+    CHECK(server.isRunning());
+    CHECK(sendAdminCommand(path, "report revenue").find("REVENUE REPORT") != std::string::npos);
+    CHECK(sendAdminCommand(path, "counts json") == "{\"Regular\": 1, \"VIP\": 1}\n");
+    server.stop();
+    CHECK(!server.isRunning());
+    CHECK(::access(path.c_str(), F_OK) != 0);
+}
+#endif
+
+int main() {
+    Logger::instance().setLevel(LogLevel::Off);
+    
+    testSlotMapHandles();
+    testStringPool();
+    testTextCodecRoundTrip();
+    testInteractionIndexSearch();
+    testInteractionIndexSkips();
+    testDuplicateDetector();
+    testCampaignScheduler();
+    testAsyncLogger();
+    testLoyaltyLedger();
+    testScoringRulesParse();
+    testScoringRulesPerCrm();
+    testLatencyHistogram();
+    testOperationMetrics();
+    testCrmAssignmentAndReports();
+    testInteractionIndexMaintenance();
+    testTopCustomerRanking();
+    testBulkReassignment();
+    testInternedSegmentCounts();
+    testInteractionCompression();
+    testAutoAssignBalancesLoad();
+    testRebalanceKeepsBusyRepPortfolio();
+    testInteractionTiering();
+    testMemoryUsage();
+    testServiceProtocol();
+    testCrmService();
+    testBatchRequests();
+    testReplicationLog();
+    testSnapshotReplay();
+    testReportSummaryMerge();
+    testReportSnapshots();
+    testReportsMatchLivePortfolios();
+    testCustomerHistory();
+#if defined(CRM_HAS_SERVER)
+    testCrmServer();
+    testReadReplica();
+    testReplicaPartialSnapshot();
+    testShardRouter();
+#endif
+#if defined(CRM_HAS_ADMIN_SERVER)
+    testAdminServer();
+#endif
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All tests passed" << std::endl;
+    return 0;
+}